@@ -2,6 +2,7 @@
 #include <JuceHeader.h>
 #include <functional>
 #include <array>
+#include <map>
 
 namespace modSys2 {
 	static constexpr float pi = 3.14159265359f;
@@ -36,7 +37,17 @@ namespace modSys2 {
 		cpi.timeSigNumerator = 1;
 		return cpi;
 	}
-	enum ChannelSetup { Left, Right, Mid, Side };
+	enum ChannelSetup : int { Left, Right, Mid, Side, Band0 };
+	/*
+	* non-owning view onto the channels of an input bus. a mono bus feeds every channel
+	*/
+	struct AudioInput {
+		const float* const* samples;
+		int numChannels;
+
+		const float* getChannel(const int ch) const noexcept { return samples[ch < numChannels ? ch : numChannels - 1]; }
+		bool isValid() const noexcept { return samples != nullptr && numChannels != 0; }
+	};
 
 	/*
 	* spline interpolation that expects indexes that never go out of bounds
@@ -70,14 +81,16 @@ namespace modSys2 {
 	};
 
 	/*
-	* makes sure things can be identified
+	* makes sure things can be identified. the id is for serialization, the handle is
+	* a dense index the matrix hands out, so lookups at runtime don't compare strings
 	*/
 	struct Identifiable {
-		Identifiable(const juce::Identifier& tID) : id(tID) {}
-		Identifiable(const juce::String& tID) : id(tID) {}
+		Identifiable(const juce::Identifier& tID, const int tHandle = -1) : id(tID), handle(tHandle) {}
+		Identifiable(const juce::String& tID, const int tHandle = -1) : id(tID), handle(tHandle) {}
 		bool hasID(const juce::Identifier& otherID) const noexcept { return id == otherID; }
 		bool operator==(const Identifiable& other) const noexcept { return id == other.id; }
 		juce::Identifier id;
+		int handle;
 	};
 	/*
 	* hermit spline interpolation
@@ -140,6 +153,7 @@ namespace modSys2 {
 				isWorking(false)
 			{}
 			void setLength(const float samples) noexcept { length = samples; }
+			bool isSmoothing() const noexcept { return isWorking; }
 			void processBlock(float* block, const float dest, const int numSamples) noexcept {
 				if (!isWorking) {
 					if (env == dest)
@@ -184,10 +198,11 @@ namespace modSys2 {
 			}
 		};
 
-		Parameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& pID) :
-			Identifiable(pID),
+		Parameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& pID, const int pHandle) :
+			Identifiable(pID, pHandle),
 			parameter(apvts.getRawParameterValue(pID)),
 			rap(apvts.getParameter(pID)),
+			range(&rap->getNormalisableRange()),
 			sumValue(0.f),
 			block(),
 			smoothing(),
@@ -199,6 +214,10 @@ namespace modSys2 {
 			block.resize(blockSize);
 		}
 		void setSmoothingLengthInSamples(const float length) noexcept { smoothing.setLength(length); }
+		/* slot parameters are read in the range of the modulator that uses them. nullptr = own range */
+		void setRange(const juce::NormalisableRange<float>* r) noexcept {
+			range.store(r != nullptr ? r : &rap->getNormalisableRange());
+		}
 		// PROCESS
 		void processBlock(const int numSamples) noexcept {
 			const auto targetValue = parameter->load();
@@ -206,10 +225,13 @@ namespace modSys2 {
 			smoothing.processBlock(block.data(), normalised, numSamples);
 		}
 		void storeSumValue(const int lastSample) noexcept { sumValue.set(block[lastSample]); }
+		/* true if the smoothed, unmodulated block holds one value all the way */
+		bool isConstant(const int numSamples) const noexcept {
+			return !smoothing.isSmoothing() && block[0] == block[numSamples - 1];
+		}
 		void set(const float value, const int s) noexcept { block[s] = value; }
 		void limit(const int numSamples) noexcept {
-			for (auto s = 0; s < numSamples; ++s)
-				block[s] = block[s] < 0.f ? 0.f : block[s] > 1.f ? 1.f : block[s];
+			juce::FloatVectorOperations::clip(block.data(), block.data(), 0.f, 1.f, numSamples);
 		}
 		// GET NORMAL
 		float getSumValue() const noexcept { return sumValue.get(); }
@@ -218,51 +240,153 @@ namespace modSys2 {
 		const std::vector<float>& data() const noexcept { return block; }
 		// GET CONVERTED
 		float denormalized(const int s = 0) const noexcept {
-			return rap->convertFrom0to1(juce::jlimit(0.f, 1.f, block[s]));
+			return range.load()->convertFrom0to1(juce::jlimit(0.f, 1.f, block[s]));
 		}
+		float getMin() const noexcept { return range.load()->start; }
+		float getMax() const noexcept { return range.load()->end; }
 	protected:
 		std::atomic<float>* parameter;
 		const juce::RangedAudioParameter* rap;
+		std::atomic<const juce::NormalisableRange<float>*> range;
 		juce::Atomic<float> sumValue;
 		std::vector<float> block;
 		Smoothing smoothing;
 		float Fs;
 	};
 
+	/*
+	* the response curve of a destination as a lookup table. rows are biases and columns
+	* are modulator values. bias .5 is linear, below bends towards the end, above towards
+	* the start. the row of the current bias is only interpolated when bias moves
+	*/
+	class ResponseCurve {
+		static constexpr int NumBiases = 33;
+		static constexpr int Size = 256;
+		static constexpr int RowSize = Size + 2; // one guard point so value 1 can be interpolated
+		static constexpr float MaxExponent = 8.f;
+	public:
+		ResponseCurve() :
+			curves(SharedObjectCache::theSharedObjectCache.get<std::vector<float>>(
+				"respcurve " + juce::String(NumBiases) + " " + juce::String(Size), makeCurves)),
+			row(RowSize, 0.f),
+			bias(-1.f)
+		{}
+		ResponseCurve(const ResponseCurve&) = default;
+		void setBias(const float b) noexcept {
+			if (bias == b) return;
+			bias = b;
+			const auto x = bias * static_cast<float>(NumBiases - 1);
+			const auto b0 = juce::jlimit(0, NumBiases - 2, static_cast<int>(x));
+			const auto frac = x - static_cast<float>(b0);
+			const auto r0 = curves->data() + b0 * RowSize;
+			const auto r1 = r0 + RowSize;
+			for (auto i = 0; i < RowSize; ++i)
+				row[i] = r0[i] + frac * (r1[i] - r0[i]);
+		}
+		float operator()(const float value) const noexcept {
+			const auto x = juce::jlimit(0.f, 1.f, value) * static_cast<float>(Size);
+			const auto i0 = static_cast<int>(x);
+			const auto frac = x - static_cast<float>(i0);
+			return row[i0] + frac * (row[i0 + 1] - row[i0]);
+		}
+		static float getShapedValue(const float value, const float b) noexcept {
+			return std::pow(value, std::pow(MaxExponent, 1.f - 2.f * b));
+		}
+	protected:
+		std::shared_ptr<const std::vector<float>> curves;
+		std::vector<float> row;
+		float bias;
+
+		static std::vector<float> makeCurves() {
+			std::vector<float> c(NumBiases * RowSize, 0.f);
+			for (auto b = 0; b < NumBiases; ++b) {
+				const auto bv = static_cast<float>(b) / static_cast<float>(NumBiases - 1);
+				for (auto i = 0; i < RowSize; ++i) {
+					const auto v = std::min(1.f, static_cast<float>(i) / static_cast<float>(Size));
+					c[b * RowSize + i] = getShapedValue(v, bv);
+				}
+			}
+			return c;
+		}
+	};
+
 	/*
 	* base class for a modulator's destination. can be parameter (mono) or arbitrary buffer
 	*/
 	struct Destination :
 		public Identifiable
 	{
-		Destination(const juce::Identifier& dID, std::vector<float>& destBlck, ChannelSetup defaultSetup, float defaultAtten = 1.f, bool defaultBidirectional = false) :
-			Identifiable(dID),
+		static constexpr float LinearBias = .5f;
+
+		Destination(const juce::Identifier& dID, std::vector<float>& destBlck, ChannelSetup defaultSetup, float defaultAtten = 1.f, bool defaultBidirectional = false, const int pHandle = -1) :
+			Identifiable(dID, pHandle),
 			attenuvertor(defaultAtten),
+			bias(LinearBias),
 			bidirectional(defaultBidirectional),
+			curve(),
 			destBlock(destBlck),
-			channelSetup(defaultSetup)
+			channelSetup(defaultSetup),
+			prevAtten(defaultAtten)
 		{
 		}
 		Destination(Destination&) = default;
 		const ChannelSetup getChannelSetup() const noexcept { return channelSetup; }
-		void processBlock(float* modBlock, const int numSamples) noexcept {
-			const auto atten = attenuvertor.get();
-			if (isBidirectional())
-				for (auto s = 0; s < numSamples; ++s)
-					destBlock[s] += (2.f * modBlock[s] - 1.f) * atten;
+		/* gain, if there is one, scales the modulation sample by sample before it's added */
+		void processBlock(float* modBlock, const int numSamples, const float* gain = nullptr) noexcept {
+			const auto dest = destBlock.data();
+			if (gain == nullptr)
+				processBlock(modBlock, numSamples, [dest](const int s, const float v) noexcept { dest[s] += v; });
 			else
-				for (auto s = 0; s < numSamples; ++s)
-					destBlock[s] += modBlock[s] * atten;
+				processBlock(modBlock, numSamples, [dest, gain](const int s, const float v) noexcept { dest[s] += gain[s] * v; });
 		}
 		void setValue(float value) noexcept { attenuvertor.set(value); }
 		float getValue() const noexcept { return attenuvertor.get(); }
+		/* bias of the response curve, LinearBias leaves the modulator's values as they are */
+		void setBias(float b) noexcept { bias.set(juce::jlimit(0.f, 1.f, b)); }
+		float getBias() const noexcept { return bias.get(); }
 		void setBirectional(bool b) noexcept { bidirectional.set(b); }
 		bool isBidirectional() const noexcept { return bidirectional.get(); }
 	protected:
-		juce::Atomic<float> attenuvertor;
+		juce::Atomic<float> attenuvertor, bias;
 		juce::Atomic<bool> bidirectional;
+		ResponseCurve curve;
 		std::vector<float>& destBlock;
 		const ChannelSetup channelSetup;
+		float prevAtten; // attenuvertor at the end of the last block, audio thread only
+
+		template<typename Add>
+		void processBlock(const float* modBlock, const int numSamples, const Add& add) noexcept {
+			const auto atten = attenuvertor.get();
+			const auto b = bias.get();
+			if (b == LinearBias)
+				processBlock(modBlock, numSamples, atten, [](const float v) noexcept { return v; }, add);
+			else {
+				curve.setBias(b);
+				processBlock(modBlock, numSamples, atten, [this](const float v) noexcept { return curve(v); }, add);
+			}
+			prevAtten = atten;
+		}
+		/*
+		* (2v - 1) * a == v * 2a - a, so bidirectional is only a different gain and offset.
+		* if the attenuvertor moved since the last block both ramp towards it across the block
+		*/
+		template<typename Shape, typename Add>
+		void processBlock(const float* modBlock, const int numSamples, const float atten, const Shape& shape, const Add& add) noexcept {
+			const auto gainScale = isBidirectional() ? 2.f : 1.f;
+			const auto offsetScale = isBidirectional() ? 1.f : 0.f;
+			if (prevAtten == atten) {
+				const auto gain = atten * gainScale;
+				const auto offset = atten * offsetScale;
+				for (auto s = 0; s < numSamples; ++s)
+					add(s, shape(modBlock[s]) * gain - offset);
+				return;
+			}
+			const auto inc = (atten - prevAtten) / static_cast<float>(numSamples);
+			for (auto s = 0; s < numSamples; ++s) {
+				const auto a = prevAtten + inc * static_cast<float>(s + 1);
+				add(s, shape(modBlock[s]) * (a * gainScale) - a * offsetScale);
+			}
+		}
 	};
 
 	/*
@@ -274,62 +398,41 @@ namespace modSys2 {
 		Modulator(const juce::Identifier& mID) :
 			Identifiable(mID),
 			params(),
-			destinations(),
 			outValue(),
+			input({ nullptr, 0 }),
+			inputBus(0),
 			Fs(1)
 		{
 		}
 		Modulator(const juce::String& mID) :
 			Identifiable(mID),
 			params(),
-			destinations(),
 			outValue(),
+			input({ nullptr, 0 }),
+			inputBus(0),
 			Fs(1)
 		{
 		}
 		// SET
 		virtual void prepareToPlay(const int numChannels, const double sampleRate) {
-			if (outValue.size() != numChannels) {
-				outValue.clear();
-				for (auto c = 0; c < numChannels; ++c)
-					outValue.push_back(juce::Atomic<float>(0.f));
-			}
+			resizeOutValues(numChannels);
 			Fs = static_cast<float>(sampleRate);
 		}
-		void addDestination(std::shared_ptr<Parameter>& dest, ChannelSetup channelSetup, float atten = 1.f, bool bidirec = false) {
-			addDestination(dest->id, dest->data(), channelSetup, atten, bidirec);
-		}
-		void addDestination(const juce::Identifier& dID, std::vector<float>& destBlock, ChannelSetup channelSetup, float atten = 1.f, bool bidirec = false) {
-			if (hasDestination(dID)) return;
-			destinations.push_back(std::make_shared<Destination>(dID, destBlock, channelSetup, atten, bidirec));
-		}
-		void removeDestination(const juce::Identifier& dID) {
-			for (auto d = 0; d < destinations.size(); ++d) {
-				auto dest = destinations[d].get();
-				if (dest->id == dID) {
-					destinations.erase(destinations.begin() + d);
-					return;
-				}
-			}
-		}
-		void removeDestinations(const Modulator* other) {
-			const auto& otherParams = other->getParameters();
-			for (const auto op : otherParams)
-				if (hasDestination(op->id))
-					removeDestination(op->id);
-		}
+		/* how many channels of the matrix' block the modulator writes to */
+		virtual int getNumOutputChannels(const int numChannels) const noexcept { return numChannels * numChannels; }
 		virtual void addStuff(const juce::String& /*sID*/, const VectorAnything& /*stuff*/) {}
+		/* how far the modulator looks ahead. the audio has to be delayed by that much */
+		virtual int getLatencySamples() const noexcept { return 0; }
+		/* modulators that read audio pick the input bus they listen to. 0 = main bus */
+		virtual bool acceptsAudio() const noexcept { return false; }
+		/* what kind of modulator this is, the same names the slot types use. lets an editor pick a display */
+		virtual const char* getTypeName() const noexcept { return ""; }
+		void setInputBus(const int bus) noexcept { inputBus.set(bus); }
+		int getInputBus() const noexcept { return inputBus.get(); }
+		/* set by the matrix before processBlock */
+		void setInput(const AudioInput& in) noexcept { input = in; }
 		// PROCESS
-		void setAttenuvertor(const juce::Identifier& pID, const float value) {
-			getDestination(pID)->setValue(value);
-		}
 		virtual void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo& playHead) = 0;
-		void processDestinations(float** block, const int numSamples) noexcept {
-			for (auto& destination : destinations) {
-				const auto channelSetup = destination->getChannelSetup();
-				destination->processBlock(block[channelSetup], numSamples);
-			}	
-		}
 		void generateMidSide(float** block, const int numChannels, const int numSamples) noexcept {
 			if (numChannels != 2) return;
 			juce::FloatVectorOperations::copy(block[2], block[0], numSamples);
@@ -344,28 +447,8 @@ namespace modSys2 {
 				outValue[ch].set(block[ch][lastSample]);
 		}
 		// GET
-		std::shared_ptr<Destination> getDestination(const juce::Identifier& pID) noexcept {
-			for (auto d = 0; d < destinations.size(); ++d)
-				if (destinations[d]->id == pID)
-					return destinations[d];
-			return nullptr;
-		}
-		const std::shared_ptr<Destination> getDestination(const juce::Identifier& pID) const noexcept {
-			for (auto d = 0; d < destinations.size(); ++d)
-				if (destinations[d]->id == pID)
-					return destinations[d];
-			return nullptr;
-		}
-		bool hasDestination(const juce::Identifier& pID) const noexcept {
-			return getDestination(pID) != nullptr;
-		}
-		const float getAttenuvertor(const juce::Identifier& pID) const noexcept {
-			return getDestination(pID)->getValue();
-		}
-		const std::vector<std::shared_ptr<Destination>>& getDestinations() const noexcept {
-			return destinations;
-		}
 		float getOutValue(const int ch) const noexcept { return outValue[ch].get(); }
+		int getNumOutValues() const noexcept { return static_cast<int>(outValue.size()); }
 		const std::vector<std::shared_ptr<Parameter>>& getParameters() const noexcept { return params; }
 		bool usesParameter(const juce::Identifier& pID) const noexcept {
 			for (const auto p : params)
@@ -379,17 +462,121 @@ namespace modSys2 {
 					return true;
 			return false;
 		}
-		bool modulates(Modulator& other) const noexcept {
-			for (const auto d : destinations)
-				if (other.usesParameter(d->id))
+		bool usesParameter(const int pHandle) const noexcept {
+			for (const auto& p : params)
+				if (p->handle == pHandle)
 					return true;
 			return false;
 		}
 	protected:
 		std::vector<std::shared_ptr<Parameter>> params;
-		std::vector<std::shared_ptr<Destination>> destinations;
 		std::vector<juce::Atomic<float>> outValue;
+		AudioInput input;
+		juce::Atomic<int> inputBus;
 		float Fs;
+
+		void resizeOutValues(const int numOutValues) {
+			if (outValue.size() == numOutValues) return;
+			outValue.clear();
+			for (auto c = 0; c < numOutValues; ++c)
+				outValue.push_back(juce::Atomic<float>(0.f));
+		}
+	};
+
+	/*
+	* the destinations of one modulator. a list that a copy of the matrix may process is never
+	* edited, the matrix edits a copy of it instead (see Matrix::editDestinations). the destinations
+	* themselves are shared by all lists, their attenuvertors are edited in place
+	*/
+	struct DestinationList {
+		DestinationList() :
+			destinations(),
+			destinationIdx()
+		{}
+		void addDestination(std::shared_ptr<Parameter>& dest, ChannelSetup channelSetup, float atten = 1.f, bool bidirec = false) {
+			if (hasDestination(dest->handle)) return;
+			destinations.push_back(std::make_shared<Destination>(dest->id, dest->data(), channelSetup, atten, bidirec, dest->handle));
+			updateDestinationIdx();
+		}
+		void addDestination(const juce::Identifier& dID, std::vector<float>& destBlock, ChannelSetup channelSetup, float atten = 1.f, bool bidirec = false) {
+			if (hasDestination(dID)) return;
+			destinations.push_back(std::make_shared<Destination>(dID, destBlock, channelSetup, atten, bidirec));
+		}
+		void removeDestination(const juce::Identifier& dID) {
+			for (auto d = 0; d < destinations.size(); ++d) {
+				auto dest = destinations[d].get();
+				if (dest->id == dID) {
+					destinations.erase(destinations.begin() + d);
+					updateDestinationIdx();
+					return;
+				}
+			}
+		}
+		void removeDestination(const int pHandle) {
+			if (!hasDestination(pHandle)) return;
+			destinations.erase(destinations.begin() + destinationIdx[pHandle]);
+			updateDestinationIdx();
+		}
+		void removeDestinations(const Modulator& other) {
+			for (const auto& op : other.getParameters())
+				removeDestination(op->handle);
+		}
+		// PROCESS
+		void processBlock(float** block, const int numSamples) const noexcept {
+			for (auto& destination : destinations) {
+				const auto channelSetup = destination->getChannelSetup();
+				destination->processBlock(block[channelSetup], numSamples);
+			}
+		}
+		/* scales the modulation of each parameter destination by gains[parameter handle], nullptr = unscaled */
+		void processBlock(float** block, const int numSamples, const float* const* gains) const noexcept {
+			for (auto& destination : destinations) {
+				const auto channelSetup = destination->getChannelSetup();
+				const auto pHandle = destination->handle;
+				destination->processBlock(block[channelSetup], numSamples, pHandle != -1 ? gains[pHandle] : nullptr);
+			}
+		}
+		// GET
+		std::shared_ptr<Destination> getDestination(const juce::Identifier& pID) const noexcept {
+			for (auto d = 0; d < destinations.size(); ++d)
+				if (destinations[d]->id == pID)
+					return destinations[d];
+			return nullptr;
+		}
+		bool hasDestination(const juce::Identifier& pID) const noexcept {
+			return getDestination(pID) != nullptr;
+		}
+		/* O(1) access to parameter destinations by the parameter's handle */
+		std::shared_ptr<Destination> getDestination(const int pHandle) const noexcept {
+			if (!hasDestination(pHandle)) return nullptr;
+			return destinations[destinationIdx[pHandle]];
+		}
+		bool hasDestination(const int pHandle) const noexcept {
+			return pHandle >= 0 && pHandle < destinationIdx.size() && destinationIdx[pHandle] != -1;
+		}
+		bool modulates(const Modulator& other) const noexcept {
+			for (const auto& d : destinations)
+				if (d->handle != -1 && other.usesParameter(d->handle))
+					return true;
+			return false;
+		}
+		std::vector<std::shared_ptr<Destination>>::const_iterator begin() const noexcept { return destinations.begin(); }
+		std::vector<std::shared_ptr<Destination>>::const_iterator end() const noexcept { return destinations.end(); }
+		size_t size() const noexcept { return destinations.size(); }
+		const std::shared_ptr<Destination>& operator[](const size_t d) const noexcept { return destinations[d]; }
+	protected:
+		std::vector<std::shared_ptr<Destination>> destinations;
+		std::vector<int> destinationIdx; // parameter handle -> index in destinations, -1 if none
+
+		void updateDestinationIdx() {
+			auto size = 0;
+			for (const auto& d : destinations)
+				size = std::max(size, d->handle + 1);
+			destinationIdx.assign(size, -1);
+			for (auto d = 0; d < destinations.size(); ++d)
+				if (destinations[d]->handle != -1)
+					destinationIdx[destinations[d]->handle] = d;
+		}
 	};
 
 	/*
@@ -401,6 +588,7 @@ namespace modSys2 {
 		MacroModulator(const std::shared_ptr<Parameter>& makroParam) :
 			Modulator(makroParam->id)
 		{ params.push_back(makroParam); }
+		const char* getTypeName() const noexcept override { return "Macro"; }
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo&) override {
 			for (auto s = 0; s < audioBuffer.getNumSamples(); ++s)
 				block[0][s] = params[0]->get(s);
@@ -415,36 +603,134 @@ namespace modSys2 {
 	class EnvelopeFollowerModulator :
 		public Modulator
 	{
-		enum { Gain, Attack, Release, Bias, Width };
+		enum { Gain, Attack, Release, Bias, Width, Detector, Window, Lookahead };
+		enum DetectorMode { Env, Peak, RMS };
+		/*
+		* sliding window peak (monotonic deque) and rms (running sum) of a channel.
+		* the rectified input is written into a ring buffer once and read from there
+		* delayed by (max lookahead - lookahead), so the reported latency stays constant
+		*/
+		class WindowDetector {
+		public:
+			WindowDetector() :
+				history(), deque(),
+				sum(0.),
+				pos(0), head(0), tail(0),
+				mask(0), delay(0), window(1), mode(-1)
+			{}
+			void prepare(const int maxDelay, const int maxWindow) {
+				auto size = 1;
+				while (size < maxDelay + maxWindow + 2) size <<= 1;
+				history.assign(size, 0.f);
+				deque.assign(size, 0);
+				mask = size - 1;
+				pos = head = tail = 0;
+				sum = 0.;
+				mode = -1;
+			}
+			/*
+			* rebuilds the running sum and the deque, but only if window, delay or mode changed.
+			* each mode only maintains its own state, so switching mode has to rebuild too
+			*/
+			void setWindow(const int delaySamples, const int windowSamples, const int detectorMode) noexcept {
+				if (delay == delaySamples && window == windowSamples && mode == detectorMode) return;
+				mode = detectorMode;
+				delay = juce::jlimit(0, mask, delaySamples);
+				window = juce::jlimit(1, mask - delay, windowSamples);
+				sum = 0.;
+				head = tail = 0;
+				const auto in = pos - 1 - delay;
+				for (auto p = in - window + 1; p <= in; ++p) {
+					const double x = history[p & mask];
+					sum += x * x;
+					pushPeak(p);
+				}
+			}
+			template<DetectorMode Mode>
+			void processBlock(float* block, const float* samples, const float* gain, const int numSamples) noexcept {
+				const auto windowInv = 1. / static_cast<double>(window);
+				for (auto s = 0; s < numSamples; ++s, ++pos) {
+					history[pos & mask] = std::abs(samples[s]) * gain[s];
+					const auto in = pos - delay;
+					if (Mode == Peak) {
+						pushPeak(in);
+						while (deque[head & mask] <= in - window) ++head;
+						block[s] = history[deque[head & mask] & mask];
+					}
+					else if (Mode == RMS) {
+						const double x = history[in & mask];
+						const double o = history[(in - window) & mask];
+						sum += x * x - o * o;
+						block[s] = static_cast<float>(std::sqrt(std::max(0., sum * windowInv)));
+					}
+					else
+						block[s] = history[in & mask];
+				}
+			}
+		protected:
+			std::vector<float> history;
+			std::vector<juce::int64> deque;
+			double sum;
+			juce::int64 pos, head, tail;
+			int mask, delay, window, mode;
+
+			void pushPeak(const juce::int64 p) noexcept {
+				const auto x = history[p & mask];
+				while (tail != head && history[deque[(tail - 1) & mask] & mask] <= x) --tail;
+				deque[tail & mask] = p;
+				++tail;
+			}
+		};
 	public:
 		EnvelopeFollowerModulator(const juce::String& mID, const std::shared_ptr<Parameter>& inputGain,
 			const std::shared_ptr<Parameter>& atkParam, const std::shared_ptr<Parameter>& rlsParam,
-			const std::shared_ptr<Parameter>& biasParam, const std::shared_ptr<Parameter>& widthParam) :
+			const std::shared_ptr<Parameter>& biasParam, const std::shared_ptr<Parameter>& widthParam,
+			const std::shared_ptr<Parameter>& detectorParam, const std::shared_ptr<Parameter>& windowParam,
+			const std::shared_ptr<Parameter>& lookaheadParam, const std::shared_ptr<Parameter>& decimationParam) :
 			Modulator(mID),
-			env()
+			env(),
+			detectors(),
+			decimated(),
+			decimationP(decimationParam),
+			maxLookahead(0),
+			decimation(1),
+			decimationPhase(0),
+			wasDecimated(false)
 		{
 			params.push_back(inputGain);
 			params.push_back(atkParam);
 			params.push_back(rlsParam);
 			params.push_back(biasParam);
 			params.push_back(widthParam);
+			params.push_back(detectorParam);
+			params.push_back(windowParam);
+			params.push_back(lookaheadParam);
 		}
 		// SET
 		void prepareToPlay(const int numChannels, const double sampleRate) override {
 			Modulator::prepareToPlay(numChannels, sampleRate);
 			env.resize(numChannels, 0.f);
-		}
+			maxLookahead = static_cast<int>(std::ceil(msInSamples(params[Lookahead]->getMax(), Fs)));
+			const auto maxWindow = static_cast<int>(std::ceil(msInSamples(params[Window]->getMax(), Fs)));
+			detectors.resize(numChannels);
+			for (auto& d : detectors)
+				d.prepare(maxLookahead, maxWindow);
+			decimated.resize(numChannels, { 0.f, 0.f, 0.f });
+			decimation = 1;
+			decimationPhase = 0;
+		}
+		int getLatencySamples() const noexcept override { return maxLookahead; }
+		bool acceptsAudio() const noexcept override { return true; }
+		const char* getTypeName() const noexcept override { return "EnvFol"; }
 		// PROCESS
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo&) override {
 			auto numChannels = audioBuffer.getNumChannels();
 			numChannels = numChannels < 3 ? numChannels : 2;
 			const auto numSamples = audioBuffer.getNumSamples();
 			const auto lastSample = numSamples - 1;
-			const auto samples = audioBuffer.getArrayOfReadPointers();
 			for (auto s = 0; s < numSamples; ++s)
 				block[1][s] = dbInGain(params[Gain]->denormalized(s));
-			for (auto s = 0; s < numSamples; ++s)
-				block[0][s] = std::abs(samples[0][s]) * block[1][s];
+			processDetectors(block, numChannels, numSamples);
 			const auto atkInMs = params[Attack]->denormalized(0);
 			const auto rlsInMs = params[Release]->denormalized(0);
 			const auto bias = 1.f - juce::jlimit(0.f, 1.f, params[Bias]->get(0));
@@ -453,8 +739,16 @@ namespace modSys2 {
 			const auto atkSpeed = 1.f / atkInSamples;
 			const auto rlsSpeed = 1.f / rlsInSamples;
 			const auto gain = makeAutoGain(atkSpeed, rlsSpeed);
-			for (auto ch = 0; ch < numChannels; ++ch)
-				processEnvelope(block, samples, ch, numSamples, atkSpeed, rlsSpeed, gain, bias);
+			const auto maxError = getMaxDecimationError();
+			if (maxError != 0.f) {
+				const auto factor = getDecimationFactor(std::min(atkInSamples, rlsInSamples), maxError);
+				processEnvelopeDecimated(block, numChannels, numSamples, factor, atkSpeed, rlsSpeed, gain, bias);
+			}
+			else {
+				for (auto ch = 0; ch < numChannels; ++ch)
+					processEnvelope(block, ch, numSamples, atkSpeed, rlsSpeed, gain, bias);
+				wasDecimated = false;
+			}
 			const auto narrow = 1.f - juce::jlimit(0.f, 1.f, params[Width]->get());
 			const auto channelInv = 1.f / numChannels;
 			for (auto s = 0; s < numSamples; ++s) {
@@ -469,29 +763,55 @@ namespace modSys2 {
 			storeOutValue(block, lastSample);
 		}
 	protected:
+		struct DecimatedEnvelope { float peak, from, to; };
+		static constexpr int MaxDecimation = 32;
+
 		std::vector<float> env;
+		std::vector<WindowDetector> detectors;
+		std::vector<DecimatedEnvelope> decimated;
+		std::shared_ptr<Parameter> decimationP;
+		int maxLookahead, decimation, decimationPhase;
+		bool wasDecimated;
 	private:
-		inline void getSamples(const juce::AudioBuffer<float>& audioBuffer, float** block) {
-			const auto samples = audioBuffer.getArrayOfReadPointers();
-			for (auto ch = 0; ch < audioBuffer.getNumChannels(); ++ch)
-				for (auto s = 0; s < audioBuffer.getNumSamples(); ++s)
-					block[ch][s] = std::abs(samples[ch][s]) * dbInGain(params[Gain]->denormalized(s));
+		/* block[1] holds the input gain until the last channel's detector overwrites it sample by sample */
+		inline void processDetectors(float** block, const int numChannels, const int numSamples) noexcept {
+			const auto mode = static_cast<int>(std::rint(params[Detector]->denormalized(0)));
+			const auto lookahead = static_cast<int>(msInSamples(params[Lookahead]->denormalized(0), Fs));
+			const auto window = static_cast<int>(msInSamples(params[Window]->denormalized(0), Fs));
+			for (auto ch = 0; ch < numChannels; ++ch) {
+				auto& d = detectors[ch];
+				d.setWindow(maxLookahead - lookahead, window, mode);
+				const auto samples = input.getChannel(ch);
+				if (mode == Peak)
+					d.processBlock<Peak>(block[ch], samples, block[1], numSamples);
+				else if (mode == RMS)
+					d.processBlock<RMS>(block[ch], samples, block[1], numSamples);
+				else
+					d.processBlock<Env>(block[ch], samples, block[1], numSamples);
+			}
+		}
+		/*
+		* the max timing error of the decimated envelope relative to the faster of atk/rls, shared
+		* by all envelope followers. 0 = per sample (default). the bound is on timing only:
+		* the output lags by one window and max pooling reads high on signals whose period is near the window
+		*/
+		const inline float getMaxDecimationError() const noexcept {
+			if (decimationP == nullptr) return 0.f;
+			return juce::jlimit(0.f, .25f, decimationP->denormalized(0));
 		}
-
 		const inline float makeAutoGain(const float atkSpeed, const float rlsSpeed) const noexcept {
 			return 1.f + std::sqrt(rlsSpeed / atkSpeed);
 		}
 		const inline float processBias(const float value, const float biasV) const noexcept {
 			return std::pow(value, biasV);
 		}
-		inline void processEnvelope(float** block, const float** samples, const int ch, const int numSamples,
+		inline void processEnvelope(float** block, const int ch, const int numSamples,
 			const float atkSpeed, const float rlsSpeed, const float gain, const float bias) {
 			for (auto s = 0; s < numSamples; ++s)
-				processEnvelopeSample(block, samples, ch, s, atkSpeed, rlsSpeed, gain, bias);
+				processEnvelopeSample(block, ch, s, atkSpeed, rlsSpeed, gain, bias);
 		}
-		inline void processEnvelopeSample(float** block, const float** samples, const int ch, const int s,
+		inline void processEnvelopeSample(float** block, const int ch, const int s,
 			const float atkSpeed, const float rlsSpeed, const float gain, const float bias) {
-			block[ch][s] = std::abs(samples[ch][s]) * block[1][s];
 			if (env[ch] < block[ch][s])
 				env[ch] += atkSpeed * (block[ch][s] - env[ch]);
 			else if (env[ch] > block[ch][s])
@@ -499,6 +819,221 @@ namespace modSys2 {
 			block[ch][s] = env[ch] * gain;
 			block[ch][s] = processBias(block[ch][s], bias);
 		}
+		/*
+		* pooling d samples shifts onsets by up to d samples, so d = t * maxError, rounded down
+		* to a power of two. the linear ramp between the results then misses the exponential
+		* by at most maxError^2 / 8 of a step on top of that
+		*/
+		const inline int getDecimationFactor(const float timeConstant, const float maxError) const noexcept {
+			const auto maxFactor = timeConstant * maxError;
+			auto factor = 1;
+			while (factor * 2 <= maxFactor && factor < MaxDecimation) factor *= 2;
+			return factor;
+		}
+		/*
+		* runs the envelope once per window on the window's max of the detector signal and
+		* ramps linearly between the results. the output lags by one window (<= MaxDecimation)
+		*/
+		inline void processEnvelopeDecimated(float** block, const int numChannels, const int numSamples,
+			const int factor, const float atkSpeed, const float rlsSpeed, const float gain, const float bias) noexcept {
+			if (!wasDecimated) {
+				for (auto ch = 0; ch < numChannels; ++ch) {
+					const auto y = processBias(env[ch] * gain, bias);
+					decimated[ch] = { 0.f, y, y };
+				}
+				decimation = factor;
+				decimationPhase = 0;
+				wasDecimated = true;
+			}
+			auto rampInc = 1.f / static_cast<float>(decimation);
+			for (auto s = 0; s < numSamples; ++s) {
+				const auto ramp = static_cast<float>(decimationPhase) * rampInc;
+				for (auto ch = 0; ch < numChannels; ++ch) {
+					auto& d = decimated[ch];
+					d.peak = std::max(d.peak, block[ch][s]);
+					block[ch][s] = d.from + ramp * (d.to - d.from);
+				}
+				if (++decimationPhase == decimation) {
+					const auto atkD = 1.f - std::pow(1.f - atkSpeed, static_cast<float>(decimation));
+					const auto rlsD = 1.f - std::pow(1.f - rlsSpeed, static_cast<float>(decimation));
+					for (auto ch = 0; ch < numChannels; ++ch) {
+						auto& d = decimated[ch];
+						env[ch] += (env[ch] < d.peak ? atkD : rlsD) * (d.peak - env[ch]);
+						d.from = d.to;
+						d.to = processBias(env[ch] * gain, bias);
+						d.peak = 0.f;
+					}
+					decimation = factor;
+					decimationPhase = 0;
+					rampInc = 1.f / static_cast<float>(decimation);
+				}
+			}
+		}
+	};
+
+	/*
+	* a multiband envelope follower modulator. linkwitz-riley crossovers split the input
+	* and every band gets followed. the bands are mono and come after the usual channels,
+	* so they can be routed with ChannelSetup Band0 and up
+	*/
+	class MultibandEnvelopeFollowerModulator :
+		public Modulator
+	{
+		enum { Gain, Attack, Release, XLow, XMid, XHigh };
+	public:
+		static constexpr int NumBands = 4;
+		using Lanes = std::array<float, NumBands>;
+		/*
+		* every band is a lane: lr4 highpass at its lower crossover and lr4 lowpass at its upper one.
+		* the lowest and highest band let their missing side pass through
+		*/
+		class CrossoverBank {
+			enum { HP0, HP1, LP0, LP1, NumStages };
+			struct Stage {
+				Lanes b0, b1, b2, a1, a2;
+			};
+			struct State {
+				std::array<Lanes, NumStages> z1, z2;
+			};
+		public:
+			CrossoverBank() :
+				stages(),
+				states(),
+				xover()
+			{
+				xover.fill(-1.f);
+				for (auto& st : stages) {
+					st.b0.fill(1.f); st.b1.fill(0.f); st.b2.fill(0.f);
+					st.a1.fill(0.f); st.a2.fill(0.f);
+				}
+			}
+			void prepare(const int numChannels) {
+				states.resize(numChannels);
+				for (auto& state : states) {
+					for (auto& z : state.z1) z.fill(0.f);
+					for (auto& z : state.z2) z.fill(0.f);
+				}
+				xover.fill(-1.f);
+			}
+			void setCrossovers(const std::array<float, NumBands - 1>& freqs, const float Fs) noexcept {
+				if (xover == freqs) return;
+				xover = freqs;
+				for (auto b = 0; b < NumBands; ++b) {
+					if (b != 0) {
+						makeButterworth(stages[HP0], b, xover[b - 1], Fs, true);
+						makeButterworth(stages[HP1], b, xover[b - 1], Fs, true);
+					}
+					if (b != NumBands - 1) {
+						makeButterworth(stages[LP0], b, xover[b], Fs, false);
+						makeButterworth(stages[LP1], b, xover[b], Fs, false);
+					}
+				}
+			}
+			/* filters one sample of a channel into all bands */
+			inline void process(Lanes& x, const float sample, const int ch) noexcept {
+				auto& state = states[ch];
+				x.fill(sample);
+				for (auto st = 0; st < NumStages; ++st) {
+					const auto& c = stages[st];
+					auto& z1 = state.z1[st];
+					auto& z2 = state.z2[st];
+					for (auto b = 0; b < NumBands; ++b) {
+						const auto y = c.b0[b] * x[b] + z1[b];
+						z1[b] = c.b1[b] * x[b] - c.a1[b] * y + z2[b];
+						z2[b] = c.b2[b] * x[b] - c.a2[b] * y;
+						x[b] = y;
+					}
+				}
+			}
+		protected:
+			std::array<Stage, NumStages> stages;
+			std::vector<State> states;
+			std::array<float, NumBands - 1> xover;
+
+			static void makeButterworth(Stage& st, const int b, const float freq, const float Fs, const bool highpass) noexcept {
+				const auto w0 = tau * juce::jlimit(1.f, Fs * .49f, freq) / Fs;
+				const auto cosW0 = std::cos(w0);
+				const auto alpha = std::sin(w0) / (2.f * .70710678f);
+				const auto a0Inv = 1.f / (1.f + alpha);
+				const auto b1 = highpass ? -(1.f + cosW0) : 1.f - cosW0;
+				st.b0[b] = std::abs(b1) * .5f * a0Inv;
+				st.b1[b] = b1 * a0Inv;
+				st.b2[b] = st.b0[b];
+				st.a1[b] = -2.f * cosW0 * a0Inv;
+				st.a2[b] = (1.f - alpha) * a0Inv;
+			}
+		};
+
+		MultibandEnvelopeFollowerModulator(const juce::String& mID, const std::shared_ptr<Parameter>& inputGain,
+			const std::shared_ptr<Parameter>& atkParam, const std::shared_ptr<Parameter>& rlsParam,
+			const std::shared_ptr<Parameter>& xLowParam, const std::shared_ptr<Parameter>& xMidParam,
+			const std::shared_ptr<Parameter>& xHighParam) :
+			Modulator(mID),
+			crossovers(),
+			env()
+		{
+			params.push_back(inputGain);
+			params.push_back(atkParam);
+			params.push_back(rlsParam);
+			params.push_back(xLowParam);
+			params.push_back(xMidParam);
+			params.push_back(xHighParam);
+			env.fill(0.f);
+		}
+		// SET
+		void prepareToPlay(const int numChannels, const double sampleRate) override {
+			Modulator::prepareToPlay(numChannels, sampleRate);
+			resizeOutValues(getNumOutputChannels(numChannels));
+			crossovers.prepare(numChannels);
+			env.fill(0.f);
+		}
+		int getNumOutputChannels(const int) const noexcept override { return Band0 + NumBands; }
+		bool acceptsAudio() const noexcept override { return true; }
+		const char* getTypeName() const noexcept override { return "MBEnvFol"; }
+		// PROCESS
+		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo&) override {
+			auto numChannels = audioBuffer.getNumChannels();
+			numChannels = numChannels < 3 ? numChannels : 2;
+			const auto numSamples = audioBuffer.getNumSamples();
+
+			auto xLow = params[XLow]->denormalized(0);
+			auto xMid = std::max(xLow, params[XMid]->denormalized(0));
+			auto xHigh = std::max(xMid, params[XHigh]->denormalized(0));
+			crossovers.setCrossovers({ xLow, xMid, xHigh }, Fs);
+
+			const auto atkSpeed = 1.f / msInSamples(params[Attack]->denormalized(0), Fs);
+			const auto rlsSpeed = 1.f / msInSamples(params[Release]->denormalized(0), Fs);
+			const auto autoGain = 1.f + std::sqrt(rlsSpeed / atkSpeed);
+			const auto channelInv = 1.f / static_cast<float>(numChannels);
+
+			Lanes x, rect;
+			for (auto s = 0; s < numSamples; ++s) {
+				const auto gain = dbInGain(params[Gain]->denormalized(s)) * channelInv;
+				rect.fill(0.f);
+				for (auto ch = 0; ch < numChannels; ++ch) {
+					crossovers.process(x, input.getChannel(ch)[s], ch);
+					for (auto b = 0; b < NumBands; ++b)
+						rect[b] += std::abs(x[b]);
+				}
+				auto sum = 0.f;
+				for (auto b = 0; b < NumBands; ++b) {
+					const auto in = rect[b] * gain;
+					const auto speed = env[b] < in ? atkSpeed : rlsSpeed;
+					env[b] += speed * (in - env[b]);
+					const auto out = juce::jlimit(0.f, 1.f, env[b] * autoGain);
+					block[Band0 + b][s] = out;
+					sum += out;
+				}
+				block[0][s] = juce::jlimit(0.f, 1.f, sum);
+			}
+			for (auto ch = 1; ch < numChannels; ++ch)
+				juce::FloatVectorOperations::copy(block[ch], block[0], numSamples);
+			generateMidSide(block, numChannels, numSamples);
+			storeOutValue(block, numSamples - 1);
+		}
+	protected:
+		CrossoverBank crossovers;
+		Lanes env;
 	};
 
 	/*
@@ -533,6 +1068,13 @@ namespace modSys2 {
 				return spline::process(tables[tableIdx].data(), x);
 			}
 			const size_t numTables() const { return tables.size(); }
+			/* the sampled tables as a key, so two function sets only share if they sound the same */
+			juce::String getContentKey() const {
+				juce::String key("wavetables " + juce::String(tableSize));
+				for (const auto& t : tables)
+					key += " " + SharedObjectCache::hashOf(t.data(), t.size() * sizeof(float));
+				return key;
+			}
 		protected:
 			std::vector<std::vector<float>> tables;
 			int tableSize;
@@ -543,8 +1085,8 @@ namespace modSys2 {
 			const std::shared_ptr<Parameter>& waveTableParam, const param::MultiRange& ranges) :
 			Modulator(mID),
 			multiRange(ranges),
-			freeID(multiRange.getID("free")),
-			syncID(multiRange.getID("sync")),
+			freeHandle(multiRange.getHandle("free")),
+			syncHandle(multiRange.getHandle("sync")),
 			phase(),
 			waveTables(),
 			fsInv(0.f)
@@ -560,17 +1102,26 @@ namespace modSys2 {
 			phase.resize(numChannels);
 			fsInv = 1.f / Fs;
 		}
+		/*
+		* "wavetables": int tableSize, then one function per table.
+		* the functions are sampled and tables with the same samples are shared by all instances
+		*/
 		void addStuff(const juce::String& sID, const VectorAnything& stuff) override {
 			if (sID == "wavetables") {
 				const auto tablesCount = static_cast<int>(stuff.size()) - 1;
-				const auto tableSize = stuff.get<int>(0);
-				waveTables.resize(tablesCount, *tableSize);
-				for (auto i = 1; i < stuff.size(); ++i) {
-					const auto wtFunc = stuff.get<std::function<float(float)>>(i);
-					waveTables.addWaveTable(*wtFunc, i - 1);
+				const auto tableSize = *stuff.get<int>(0);
+				WaveTables wt;
+				wt.resize(tablesCount, tableSize);
+				for (auto i = 0; i < tablesCount; ++i) {
+					const auto wtFunc = stuff.get<std::function<float(float)>>(i + 1);
+					wt.addWaveTable(*wtFunc, i);
 				}
+				waveTables = SharedObjectCache::theSharedObjectCache.get<WaveTables>(wt.getContentKey(), [&wt]() {
+					return std::move(wt);
+				});
 			}
 		}
+		const char* getTypeName() const noexcept override { return "LFO"; }
 		// PROCESS
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo& playHead) override {
 			const auto numChannels = audioBuffer.getNumChannels();
@@ -580,7 +1131,7 @@ namespace modSys2 {
 
 			if (isFree) {
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get());
-				const auto rate = multiRange(freeID).convertFrom0to1(rateValue);
+				const auto rate = multiRange(freeHandle).convertFrom0to1(rateValue);
 				const auto inc = rate * fsInv;
 				processPhase(block, inc, 0, numSamples);
 			}
@@ -591,7 +1142,7 @@ namespace modSys2 {
 				const auto barLengthInSamples = quarterNoteLengthInSamples * 4.;
 				const auto ppq = playHead.ppqPosition * .25;
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get());
-				const auto rate = multiRange(syncID).convertFrom0to1(rateValue);
+				const auto rate = multiRange(syncHandle).convertFrom0to1(rateValue);
 				const auto inc = 1.f / (static_cast<float>(barLengthInSamples) * rate);
 				const auto ppqCh = static_cast<float>(ppq) / rate;
 				auto newPhase = (ppqCh - std::floor(ppqCh));
@@ -617,15 +1168,17 @@ namespace modSys2 {
 				for (auto ch = 1; ch < numChannels; ++ch)
 					for (auto s = 0; s < numSamples; ++s)
 						block[ch][s] = block[0][s];
-			processWaveTable(block, numChannels, numSamples);
+			// without tables the phase itself is the output, a saw
+			if (waveTables != nullptr)
+				processWaveTable(block, numChannels, numSamples);
 			generateMidSide(block, numChannels, numSamples);
 			storeOutValue(block, lastSample);
 		}
 	protected:
 		const param::MultiRange& multiRange;
-		const juce::Identifier& freeID, syncID;
+		const int freeHandle, syncHandle;
 		std::vector<float> phase;
-		WaveTables waveTables;
+		std::shared_ptr<const WaveTables> waveTables;
 		float fsInv;
 
 		inline void processPhase(float** block, const float inc,
@@ -639,10 +1192,12 @@ namespace modSys2 {
 		}
 
 		void processWaveTable(float** block, const int numChannels, const int numSamples) {
+			const auto& wt = *waveTables;
 			for (auto ch = 0; ch < numChannels; ++ch) {
-				auto wtValue = static_cast<int>(params[WaveTable]->denormalized());
+				const auto maxTable = static_cast<int>(wt.numTables()) - 1;
+				auto wtValue = juce::jlimit(0, maxTable, static_cast<int>(params[WaveTable]->denormalized()));
 				for (auto s = 0; s < numSamples; ++s)
-					block[ch][s] = waveTables(block[ch][s], wtValue);
+					block[ch][s] = wt(block[ch][s], wtValue);
 			}
 		}
 	};
@@ -654,42 +1209,123 @@ namespace modSys2 {
 		public Modulator
 	{
 		enum { Sync, Rate, Bias, Width, Smooth };
-		struct LP1Pole {
-			LP1Pole() :
-				env(0.f),
-				cutoff(.0001f)
+		/*
+		* cascaded 1 pole lowpass filters. all stages run in one pass over the block
+		* and the channels are interleaved into lanes, so that the lane loops vectorize
+		*/
+		struct LP1PoleCascade {
+			static constexpr int MaxOrder = 4;
+			static constexpr int MaxLanes = 4;
+			using Lanes = std::array<float, MaxLanes>;
+			LP1PoleCascade() :
+				env(),
+				cutoff(.0001f),
+				order(0)
 			{}
-			void processBlock(float* block, const int numSamples) noexcept {
-				for (auto s = 0; s < numSamples; ++s)
-					block[s] = process(block[s]);
+			void prepare(const int filterOrder) noexcept {
+				order = juce::jlimit(0, MaxOrder, filterOrder);
+				for (auto& stage : env)
+					stage.fill(0.f);
 			}
-			const float process(const float sample) noexcept {
-				env += cutoff * (sample - env);
-				return env;
+			void setCutoff(float amount, float rateInSlew) noexcept {
+				cutoff = 1.f + amount * (rateInSlew - 1.f);
+			}
+			void processBlock(float** block, const int numChannels, const int numSamples) noexcept {
+				const auto numLanes = numChannels < MaxLanes ? numChannels : MaxLanes;
+				Lanes x;
+				x.fill(0.f);
+				for (auto s = 0; s < numSamples; ++s) {
+					for (auto l = 0; l < numLanes; ++l)
+						x[l] = block[l][s];
+					for (auto o = 0; o < order; ++o) {
+						auto& e = env[o];
+						for (auto l = 0; l < MaxLanes; ++l) {
+							e[l] += cutoff * (x[l] - e[l]);
+							x[l] = e[l];
+						}
+					}
+					for (auto l = 0; l < numLanes; ++l)
+						block[l][s] = x[l];
+				}
+				flushDenormals();
+			}
+		protected:
+			std::array<Lanes, MaxOrder> env;
+			float cutoff;
+			int order;
+
+			/* independent of the host's ScopedNoDenormals, because the filters decay to 0 for ages */
+			void flushDenormals() noexcept {
+				static constexpr float threshold = 1e-15f;
+				for (auto& stage : env)
+					for (auto& e : stage)
+						e = std::abs(e) < threshold ? 0.f : e;
 			}
-			float env, cutoff;
 		};
-		struct LP1PoleOrder {
-			LP1PoleOrder(int order) :
-				filters()
-			{
-				filters.resize(order);
+		/*
+		* the bias curve as a lookup table. rows are biases and columns are values.
+		* the row of the current bias is interpolated lazily, only when bias moves
+		*/
+		class BiasTable {
+			static constexpr int NumBiases = 65;
+			static constexpr int Size = 512;
+			static constexpr int RowSize = Size + 1;
+		public:
+			BiasTable() :
+				curves(SharedObjectCache::theSharedObjectCache.get<std::vector<float>>(
+					"randbias " + juce::String(NumBiases) + " " + juce::String(Size), makeCurves)),
+				row(RowSize, 0.f),
+				bias(-1.f)
+			{}
+			void setBias(const float b) noexcept {
+				if (bias == b) return;
+				bias = b;
+				const auto x = bias * static_cast<float>(NumBiases - 1);
+				const auto b0 = juce::jlimit(0, NumBiases - 2, static_cast<int>(x));
+				const auto frac = x - static_cast<float>(b0);
+				const auto r0 = curves->data() + b0 * RowSize;
+				const auto r1 = r0 + RowSize;
+				for (auto i = 0; i < RowSize; ++i)
+					row[i] = r0[i] + frac * (r1[i] - r0[i]);
 			}
-			void setCutoff(float amount, float rateInSlew) {
-				const auto cutoff = 1.f + amount * (rateInSlew - 1.f);
-				for (auto& f : filters)
-					f.cutoff = cutoff;
+			/* draws num random values and shapes them in one go */
+			void drawBiased(juce::Random& rand, float* values, const int num) const noexcept {
+				for (auto i = 0; i < num; ++i)
+					values[i] = rand.nextFloat();
+				for (auto i = 0; i < num; ++i) {
+					const auto x = values[i] * static_cast<float>(Size);
+					const auto i0 = static_cast<int>(x);
+					const auto frac = x - static_cast<float>(i0);
+					values[i] = row[i0] + frac * (row[i0 + 1] - row[i0]);
+				}
 			}
-			void processBlock(float* block, const int numSamples) noexcept {
-				for (auto f = 0; f < filters.size(); ++f)
-					filters[f].processBlock(block, numSamples);
+			static float getBiasedValue(const float value, const float b) noexcept {
+				static constexpr float minA = .00001f;
+				if (b < .5f) {
+					const auto a = std::max(minA, b * 2.f);
+					return std::atan(std::tan(value * pi - .5f * pi) * a) / pi + .5f;
+				}
+				const auto a = std::max(minA, 1.f - (2.f * b - 1.f));
+				return std::atan(std::tan(value * pi - .5f * pi) / a) / pi + .5f;
 			}
-			const float process(float sample) noexcept {
-				for (auto& f : filters)
-					sample = f.process(sample);
-				return sample;
+		protected:
+			std::shared_ptr<const std::vector<float>> curves;
+			std::vector<float> row;
+			float bias;
+
+			static std::vector<float> makeCurves() {
+				// edges are pulled in by half a step because tan explodes at them
+				static constexpr float edge = .5f / static_cast<float>(Size);
+				std::vector<float> c(NumBiases * RowSize, 0.f);
+				for (auto b = 0; b < NumBiases; ++b) {
+					const auto bv = static_cast<float>(b) / static_cast<float>(NumBiases - 1);
+					for (auto i = 0; i < RowSize; ++i) {
+						const auto v = juce::jlimit(edge, 1.f - edge, static_cast<float>(i) / static_cast<float>(Size));
+						c[b * RowSize + i] = juce::jlimit(0.f, 1.f, getBiasedValue(v, bv));
+					}
+				}
+				return c;
 			}
-			std::vector<LP1Pole> filters;
 		};
 	public:
 		RandomModulator(const juce::String& mID, const std::shared_ptr<Parameter>& syncParam,
@@ -698,8 +1334,8 @@ namespace modSys2 {
 			const param::MultiRange& ranges) :
 			Modulator(mID),
 			multiRange(ranges),
-			freeID(multiRange.getID("free")),
-			syncID(multiRange.getID("sync")),
+			freeHandle(multiRange.getHandle("free")),
+			syncHandle(multiRange.getHandle("sync")),
 			randValue(),
 			smoothing(),
 			rand(juce::Time::currentTimeMillis()),
@@ -715,10 +1351,11 @@ namespace modSys2 {
 		void prepareToPlay(const int numChannels, const double sampleRate) override {
 			Modulator::prepareToPlay(numChannels, sampleRate);
 			static constexpr auto filterOrder = 3;
-			smoothing.resize(numChannels, filterOrder);
+			smoothing.prepare(filterOrder);
 			randValue.resize(numChannels, 0);
 			fsInv = 1.f / Fs;
 		}
+		const char* getTypeName() const noexcept override { return "Rand"; }
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo& playHead) override {
 			auto numChannels = audioBuffer.getNumChannels();
 			numChannels = numChannels < 3 ? numChannels : 2;
@@ -726,14 +1363,13 @@ namespace modSys2 {
 			const auto lastSample = numSamples - 1;
 
 			const bool isFree = params[Sync]->get(0) < .5f;
-			const auto biasValue = juce::jlimit(0.f, 1.f, params[Bias]->get(0));
+			biasTable.setBias(juce::jlimit(0.f, 1.f, params[Bias]->get(0)));
 
 			if (isFree) {
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get(0));
-				rateInHz = multiRange(freeID).convertFrom0to1(rateValue);
+				rateInHz = multiRange(freeHandle).convertFrom0to1(rateValue);
 				const auto inc = rateInHz * fsInv;
 				synthesizePhase(block, inc, numSamples);
-				synthesizeRandomSignal(block, biasValue, numSamples, 0);
 			}
 			else {
 				const auto bpm = playHead.bpm;
@@ -742,24 +1378,25 @@ namespace modSys2 {
 				const auto barLengthInSamples = quarterNoteLengthInSamples * 4.;
 				const auto ppq = playHead.ppqPosition * .25;
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get(0));
-				rateInHz = multiRange(syncID).convertFrom0to1(rateValue);
+				rateInHz = multiRange(syncHandle).convertFrom0to1(rateValue);
 				const auto inc = 1.f / (static_cast<float>(barLengthInSamples) * rateInHz);
 				const auto ppqCh = static_cast<float>(ppq) / rateInHz;
 				auto newPhase = (ppqCh - std::floor(ppqCh));
 				phase = newPhase;
 				synthesizePhase(block, inc, numSamples);
-				synthesizeRandomSignal(block, biasValue, numSamples, 0);
 			}
-			processWidth(block, biasValue, numChannels, numSamples);
+			synthesizeRandomSignal(block, numChannels, numSamples);
+			processWidth(block, numChannels, numSamples);
 			processSmoothing(block, numChannels, numSamples);
 			generateMidSide(block, numChannels, numSamples);
 			storeOutValue(block, numSamples - 1);
 		}
 	protected:
 		const param::MultiRange& multiRange;
-		const juce::Identifier& freeID, syncID;
+		const int freeHandle, syncHandle;
 		std::vector<float> randValue;
-		std::vector<LP1PoleOrder> smoothing;
+		LP1PoleCascade smoothing;
+		BiasTable biasTable;
 		juce::Random rand;
 		float phase, fsInv, rateInHz;
 	private:
@@ -772,23 +1409,23 @@ namespace modSys2 {
 					--phase;
 			}
 		}
-		inline void synthesizeRandomSignal(float** block, const float bias,
-			const int numSamples, const int ch) noexcept {
+		/* block[1] holds the triggers. all channels are drawn together on a trigger */
+		inline void synthesizeRandomSignal(float** block, const int numChannels, const int numSamples) noexcept {
+			const auto widthValue = juce::jlimit(0.f, 1.f, params[Width]->get(0));
+			const auto numDraws = widthValue != 0.f ? numChannels : 1;
 			for (auto s = 0; s < numSamples; ++s) {
 				if (block[1][s] == 1.f)
-					randValue[ch] = getBiasedValue(rand.nextFloat(), bias);
-				block[ch][s] = randValue[ch];
+					biasTable.drawBiased(rand, randValue.data(), numDraws);
+				for (auto ch = 0; ch < numDraws; ++ch)
+					block[ch][s] = randValue[ch];
 			}
 		}
-		inline void processWidth(float** block, const float biasValue,
-			const int numChannels, const int numSamples) noexcept {
+		inline void processWidth(float** block, const int numChannels, const int numSamples) noexcept {
 			const auto widthValue = juce::jlimit(0.f, 1.f, params[Width]->get(0));
 			if (widthValue != 0.f)
-				for (auto ch = 1; ch < numChannels; ++ch) {
-					synthesizeRandomSignal(block, biasValue, numSamples, ch);
+				for (auto ch = 1; ch < numChannels; ++ch)
 					for (auto s = 0; s < numSamples; ++s)
 						block[ch][s] = block[0][s] + widthValue * (block[ch][s] - block[0][s]);
-				}
 			else
 				for (auto ch = 1; ch < numChannels; ++ch)
 					for (auto s = 0; s < numSamples; ++s)
@@ -799,75 +1436,93 @@ namespace modSys2 {
 			const auto rateInSlew = hzInSlewRate(rateInHz, Fs);
 			static constexpr auto magicNumber = .9998f;
 			const auto smoothValue = weight(params[Smooth]->get(0), magicNumber);
-			for (auto ch = 0; ch < numChannels; ++ch) {
-				smoothing[ch].setCutoff(smoothValue, rateInSlew);
-				smoothing[ch].processBlock(block[ch], numSamples);
-			}
-		}
-		const float getBiasedValue(float value, float bias) const noexcept {
-			if (bias < .5f) {
-				const auto a = bias * 2.f;
-				return std::atan(std::tan(value * pi - .5f * pi) * a) / pi + .5f;
-			}
-			const auto a = 1.f - (2.f * bias - 1.f);
-			return std::atan(std::tan(value * pi - .5f * pi) / a) / pi + .5f;
+			smoothing.setCutoff(smoothValue, rateInSlew);
+			smoothing.processBlock(block, numChannels, numSamples);
 		}
 	};
 
 	/*
 	* a randomized modulator (1d perlin noise)
+	* value noise interpolates random values with a hermite spline,
+	* gradient noise interpolates random slopes and doesn't overshoot
 	*/
 	class PerlinModulator :
 		public Modulator
 	{
-		enum { Sync, Rate, Octaves, Width };
+		enum { Sync, Rate, Octaves, Width, Noise };
 	public:
+		enum class NoiseType { Value, Gradient };
+		static constexpr int Lanes = 4;
+		static constexpr int MaxOctaves = 12; // a multiple of Lanes
+		static_assert(MaxOctaves % Lanes == 0, "octaves are processed in groups of Lanes");
+		static constexpr int NumRandSeeds = 16;
+		/*
+		* random values and slopes. each modulator draws one of NumRandSeeds seeds,
+		* so modulators sound different but still share their tables most of the time
+		*/
+		struct NoiseSeeds {
+			NoiseSeeds(const int seedSize, const juce::int64 randSeed) :
+				seed(seedSize + spline::Size, 0.f),
+				gradient(seedSize + spline::Size, 0.f)
+			{
+				juce::Random rand(randSeed);
+				for (auto s = 0; s < seedSize; ++s)
+					seed[s] = rand.nextFloat() * .8f; // .8f compensates for spline overshoot
+				for (auto s = 0; s < seedSize; ++s)
+					gradient[s] = rand.nextFloat() * 2.f - 1.f;
+				for (auto s = seedSize; s < seed.size(); ++s) {
+					seed[s] = seed[s - seedSize];
+					gradient[s] = gradient[s - seedSize];
+				}
+			}
+			std::vector<float> seed, gradient;
+		};
 		PerlinModulator(const juce::String& mID, const std::shared_ptr<Parameter>& syncParam,
 			const std::shared_ptr<Parameter>& rateParam, const std::shared_ptr<Parameter>& octavesParam,
-			const std::shared_ptr<Parameter>& widthParam,
+			const std::shared_ptr<Parameter>& widthParam, const std::shared_ptr<Parameter>& noiseParam,
 			const param::MultiRange& ranges, const int maxNumOctaves) :
 			Modulator(mID),
 			multiRange(ranges),
-			freeID(multiRange.getID("free")),
-			syncID(multiRange.getID("sync")),
-			seed(),
-			seedSize(1 << maxNumOctaves),
-			maxOctaves(maxNumOctaves),
-			phase(0), fsInv(0), gainAccum(1),
+			freeHandle(multiRange.getHandle("free")),
+			syncHandle(multiRange.getHandle("sync")),
+			seedSize(1 << juce::jlimit(1, MaxOctaves, maxNumOctaves)),
+			randSeed(juce::Random().nextInt(NumRandSeeds) + 1),
+			seeds(SharedObjectCache::theSharedObjectCache.get<NoiseSeeds>(
+				"perlin " + juce::String(seedSize) + " " + juce::String(randSeed),
+				[size = seedSize, rs = randSeed]() { return NoiseSeeds(size, rs); })),
+			seed(seeds->seed.data()), gradient(seeds->gradient.data()),
+			octScale(), octGain(),
+			maxOctaves(juce::jlimit(1, MaxOctaves, maxNumOctaves)),
+			phase(0), fsInv(0),
 			octaves(-1)
 		{
 			params.push_back(syncParam);
 			params.push_back(rateParam);
 			params.push_back(octavesParam);
 			params.push_back(widthParam);
-
-			seed.resize(seedSize + spline::Size, 0.f);
-			juce::Random rand;
-			for (auto s = 0; s < seedSize; ++s)
-				seed[s] = rand.nextFloat() * .8f; // .8f compensates for spline overshoot
-			for (auto s = seedSize; s < seed.size(); ++s)
-				seed[s] = seed[s - seedSize];
+			params.push_back(noiseParam);
+			octScale.fill(0.f);
+			octGain.fill(0.f);
 		}
 		void prepareToPlay(const int numChannels, const double sampleRate) override {
 			Modulator::prepareToPlay(numChannels, sampleRate);
 			fsInv = 1.f / static_cast<float>(Fs);
 		}
+		const char* getTypeName() const noexcept override { return "Perlin"; }
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, float** block, juce::AudioPlayHead::CurrentPositionInfo& playHead) override {
 			auto numChannels = audioBuffer.getNumChannels();
 			numChannels = numChannels < 3 ? numChannels : 2;
 			const auto maxChannel = numChannels - 1;
 			const auto numSamples = audioBuffer.getNumSamples();
-			const auto lastSample = numSamples - 1;
 
 			const bool isFree = params[Sync]->get(0) < .5f;
 			setOctaves(juce::jlimit(0, maxOctaves, static_cast<int>(params[Octaves]->denormalized())));
 
 			if (isFree) {
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get(0));
-				const auto rateInHz = multiRange(freeID).convertFrom0to1(rateValue);
+				const auto rateInHz = multiRange(freeHandle).convertFrom0to1(rateValue);
 				const auto inc = rateInHz * fsInv;
 				synthesizePhase(block[maxChannel], inc, numSamples);
-				synthesizeRandSignal(block, numChannels, numSamples);
 			}
 			else {
 				const auto bpm = playHead.bpm;
@@ -876,36 +1531,45 @@ namespace modSys2 {
 				const auto barLengthInSamples = quarterNoteLengthInSamples * 4.;
 				const auto ppq = playHead.ppqPosition * .25;
 				const auto rateValue = juce::jlimit(0.f, 1.f, params[Rate]->get(0));
-				const auto rateInHz = multiRange(syncID).convertFrom0to1(rateValue);
+				const auto rateInHz = multiRange(syncHandle).convertFrom0to1(rateValue);
 				const auto inc = 1.f / (static_cast<float>(barLengthInSamples) * rateInHz);
 				const auto ppqCh = static_cast<float>(ppq) / rateInHz;
 				auto newPhase = (ppqCh - std::floor(ppqCh));
 				phase = newPhase;
 				synthesizePhase(block[maxChannel], inc, numSamples);
-				synthesizeRandSignal(block, numChannels, numSamples);
 			}
+			if (params[Noise]->get(0) >= .5f)
+				synthesizeRandSignal<NoiseType::Gradient>(block, numChannels, numSamples);
+			else
+				synthesizeRandSignal<NoiseType::Value>(block, numChannels, numSamples);
 			processWidth(block, numChannels, numSamples);
 			generateMidSide(block, numChannels, numSamples);
 			storeOutValue(block, numSamples - 1);
 		}
 	protected:
 		const param::MultiRange& multiRange;
-		const juce::Identifier& freeID, syncID;
-		std::vector<float> seed;
-		const int seedSize, maxOctaves;
-		float phase, fsInv, gainAccum;
+		const int freeHandle, syncHandle;
+		const int seedSize, randSeed;
+		std::shared_ptr<const NoiseSeeds> seeds;
+		const float *seed, *gradient;
+		std::array<float, MaxOctaves> octScale, octGain;
+		const int maxOctaves;
+		float phase, fsInv;
 		int octaves;
 
+		/* scales and autogained gains of the octaves, so they don't have to be calculated per sample */
 		void setOctaves(const int oct) noexcept {
 			if (octaves == oct) return;
 			octaves = oct;
-			gainAccum = 0.f;
-			for (auto o = 0; o < octaves; ++o) {
-				const auto scl = static_cast<float>(1 << o);
-				const auto gain = 1.f / scl;
-				gainAccum += gain;
+			auto gainAccum = 0.f;
+			for (auto o = 0; o < MaxOctaves; ++o) {
+				octScale[o] = static_cast<float>(1 << o);
+				octGain[o] = o < octaves ? 1.f / octScale[o] : 0.f;
+				gainAccum += octGain[o];
 			}
-			gainAccum = 1.f / gainAccum;
+			if (gainAccum != 0.f)
+				for (auto& g : octGain)
+					g /= gainAccum;
 		}
 
 		inline void synthesizePhase(float* block, const float inc, const int numSamples) noexcept {
@@ -916,25 +1580,59 @@ namespace modSys2 {
 				block[s] = phase;
 			}
 		}
+		/*
+		* the octaves of a sample are evaluated in groups of Lanes. the inner loops have a fixed
+		* trip count so they vectorize, the octaves that don't fill a group are a scalar tail.
+		* seedSize is a power of 2, so the index wraps with a bitmask instead of a while loop
+		*/
+		template<NoiseType Type>
 		inline void synthesizeRandSignal(float** block, const int numChannels, const int numSamples) noexcept {
 			const auto maxChannel = numChannels - 1;
+			const auto wrap = seedSize - 1;
+			const auto numGrouped = octaves / Lanes * Lanes;
+			std::array<int, Lanes> idx;
+			std::array<float, Lanes> frac, noise;
 			for (auto ch = 0; ch < numChannels; ++ch) {
-				auto offset = ch * seedSize * .5f;
+				const auto offset = static_cast<float>(ch * seedSize) * .5f;
 				for (auto s = 0; s < numSamples; ++s) {
-					auto noise = 0.f;
-					for (int o = 0; o < octaves; ++o) {
-						const auto scl = static_cast<float>(1 << o);
-						auto x = block[maxChannel][s] * scl + offset;
-						while (x >= seedSize)
-							x -= seedSize;
-						const auto gain = 1.f / scl;
-						noise += spline::process(seed.data(), x) * gain;
+					const auto x0 = block[maxChannel][s];
+					auto sum = 0.f;
+					for (auto o = 0; o < numGrouped; o += Lanes) {
+						for (auto l = 0; l < Lanes; ++l) {
+							const auto x = x0 * octScale[o + l] + offset;
+							const auto xInt = static_cast<int>(x); // x is never negative, so this is floor
+							idx[l] = xInt & wrap;
+							frac[l] = x - static_cast<float>(xInt);
+						}
+						for (auto l = 0; l < Lanes; ++l)
+							noise[l] = getNoise<Type>(idx[l], frac[l]);
+						for (auto l = 0; l < Lanes; ++l)
+							sum += noise[l] * octGain[o + l];
+					}
+					for (auto o = numGrouped; o < octaves; ++o) {
+						const auto x = x0 * octScale[o] + offset;
+						const auto xInt = static_cast<int>(x);
+						sum += getNoise<Type>(xInt & wrap, x - static_cast<float>(xInt)) * octGain[o];
 					}
-					noise *= gainAccum;
-					block[ch][s] = noise;
+					block[ch][s] = sum;
 				}
 			}
 		}
+		template<NoiseType Type>
+		inline float getNoise(const int i, const float frac) const noexcept {
+			if (Type == NoiseType::Gradient) {
+				// 1d perlin noise with quintic fade. stays within [-.5, .5] so no compensation needed
+				const auto g0 = gradient[i] * frac;
+				const auto g1 = gradient[i + 1] * (frac - 1.f);
+				const auto fade = frac * frac * frac * (frac * (frac * 6.f - 15.f) + 10.f);
+				return g0 + fade * (g1 - g0) + .5f;
+			}
+			const auto data = seed + i;
+			const auto c1 = .5f * (data[2] - data[0]);
+			const auto c2 = data[0] - 2.5f * data[1] + 2.f * data[2] - .5f * data[3];
+			const auto c3 = 1.5f * (data[1] - data[2]) + .5f * (data[3] - data[0]);
+			return ((c3 * frac + c2) * frac + c1) * frac + data[1];
+		}
 		inline void processWidth(float** block, const int numChannels, const int numSamples) noexcept {
 			const auto narrow = 1.f - params[Width]->get();
 			for (auto ch = 1; ch < numChannels; ++ch)
@@ -943,6 +1641,96 @@ namespace modSys2 {
 		}
 	};
 
+	/*
+	* delays the audio by the matrix' latency, so that lookahead modulators are ahead of it
+	*/
+	struct AudioDelay {
+		AudioDelay() :
+			ring(),
+			delay(0), writeIdx(0)
+		{}
+		void prepare(const int numChannels, const int delaySamples) {
+			delay = delaySamples;
+			writeIdx = 0;
+			ring.setSize(numChannels, delay > 0 ? delay : 1, false, true, false);
+			ring.clear();
+		}
+		void processBlock(juce::AudioBuffer<float>& buffer) noexcept {
+			if (delay == 0) return;
+			const auto numChannels = std::min(buffer.getNumChannels(), ring.getNumChannels());
+			const auto numSamples = buffer.getNumSamples();
+			auto samples = buffer.getArrayOfWritePointers();
+			auto r = ring.getArrayOfWritePointers();
+			auto w = writeIdx;
+			for (auto ch = 0; ch < numChannels; ++ch) {
+				w = writeIdx;
+				for (auto s = 0; s < numSamples; ++s) {
+					const auto y = r[ch][w];
+					r[ch][w] = samples[ch][s];
+					samples[ch][s] = y;
+					if (++w == delay) w = 0;
+				}
+			}
+			writeIdx = w;
+		}
+	protected:
+		juce::AudioBuffer<float> ring;
+		int delay, writeIdx;
+	};
+
+	/*
+	* room for modulators that come and go at runtime. slot s owns the paramsPerSlot parameters
+	* from firstParameter + s * paramsPerSlot and a fixed modulator handle. every modulator a slot
+	* ever held stays in the pool, so switching a slot to a type it had before doesn't allocate.
+	* shared by all copies of a matrix and only touched on the message thread
+	*/
+	struct SlotPool {
+		using Create = std::function<std::shared_ptr<Modulator>(const juce::String&, const std::vector<std::shared_ptr<Parameter>>&)>;
+		struct SlotType {
+			juce::String name;
+			std::vector<juce::NormalisableRange<float>> ranges; // what the slot's parameters mean to this type
+			Create create;
+		};
+
+		SlotPool(const int firstParam, const int slotsCount, const int numParamsPerSlot, const int firstModHandle) :
+			types(),
+			pool(slotsCount),
+			firstParameter(firstParam),
+			paramsPerSlot(numParamsPerSlot),
+			firstHandle(firstModHandle)
+		{}
+		int addType(const juce::String& name, std::vector<juce::NormalisableRange<float>>&& ranges, Create&& create) {
+			types.push_back(std::make_unique<const SlotType>(SlotType{ name, std::move(ranges), std::move(create) }));
+			for (auto& slot : pool)
+				slot.resize(types.size());
+			return static_cast<int>(types.size()) - 1;
+		}
+		int getNumSlots() const noexcept { return static_cast<int>(pool.size()); }
+		int getNumTypes() const noexcept { return static_cast<int>(types.size()); }
+		int getTypeIndex(const juce::String& name) const noexcept {
+			for (auto t = 0; t < types.size(); ++t)
+				if (types[t]->name == name)
+					return t;
+			return -1;
+		}
+		const SlotType& getType(const int t) const noexcept { return *types[t]; }
+		std::shared_ptr<Modulator>& getModulator(const int slot, const int t) noexcept { return pool[slot][t]; }
+		const std::vector<std::vector<std::shared_ptr<Modulator>>>& getModulators() const noexcept { return pool; }
+		int getParameterHandle(const int slot, const int p) const noexcept { return firstParameter + slot * paramsPerSlot + p; }
+		/* the slot a parameter belongs to, -1 if it's no slot parameter */
+		int getSlotOfParameter(const int pHandle) const noexcept {
+			const auto idx = pHandle - firstParameter;
+			return idx >= 0 && idx < getNumSlots() * paramsPerSlot ? idx / paramsPerSlot : -1;
+		}
+		int getIndexInSlot(const int pHandle) const noexcept { return (pHandle - firstParameter) % paramsPerSlot; }
+		int getModulatorHandle(const int slot) const noexcept { return firstHandle + slot; }
+		juce::String getModulatorID(const int slot) const { return "Slot" + static_cast<juce::String>(slot); }
+	protected:
+		std::vector<std::unique_ptr<const SlotType>> types;
+		std::vector<std::vector<std::shared_ptr<Modulator>>> pool; // [slot][type]
+		int firstParameter, paramsPerSlot, firstHandle;
+	};
+
 	/*
 	* some identifiers used for serialization
 	*/
@@ -954,7 +1742,11 @@ namespace modSys2 {
 			channelSetup("channelSetup"),
 			id("id"),
 			atten("atten"),
+			bias("bias"),
 			bidirec("bidirec"),
+			inputBus("inputBus"),
+			slots("SLOTS"),
+			slot("SLOT"),
 			param("PARAM")
 		{}
 		const juce::Identifier modSys;
@@ -963,9 +1755,609 @@ namespace modSys2 {
 		const juce::Identifier channelSetup;
 		const juce::Identifier id;
 		const juce::Identifier atten;
+		const juce::Identifier bias;
 		const juce::Identifier bidirec;
+		const juce::Identifier inputBus;
+		const juce::Identifier slots;
+		const juce::Identifier slot;
 		const juce::Identifier param;
 	};
+	/*
+	* lock-free handover of the newest T from one writer to one reader. the writer fills
+	* getWriteBuffer() and publishes it, the reader gets the newest published one.
+	* neither of them ever waits for the other
+	*/
+	template<class T>
+	struct TripleBuffer {
+		TripleBuffer(const T& initial) :
+			buffers{ { initial, initial, initial } },
+			writeIdx(0),
+			readIdx(1),
+			middle(2)
+		{}
+		T& getWriteBuffer() noexcept { return buffers[writeIdx]; }
+		void publish() noexcept { writeIdx = middle.exchange(writeIdx | NewData) & IdxMask; }
+		/* stays valid until the next read */
+		const T& read() noexcept {
+			if (middle.load() & NewData)
+				readIdx = middle.exchange(readIdx) & IdxMask;
+			return buffers[readIdx];
+		}
+	protected:
+		static constexpr int NewData = 4, IdxMask = 3;
+		std::array<T, 3> buffers;
+		int writeIdx, readIdx;
+		std::atomic<int> middle; // index of the buffer in between, | NewData if the reader hasn't seen it yet
+	};
+
+	/*
+	* the values the audio thread measured at the end of one block, indexed by handles.
+	* routings and the selection are edits, the editor reads them from the matrix
+	*/
+	struct UISnapshot {
+		static constexpr int MaxOutValues = ChannelSetup::Band0 + MultibandEnvelopeFollowerModulator::NumBands;
+
+		UISnapshot(const int numParameters = 0, const int numModulators = 0) :
+			sumValues(numParameters, 0.f),
+			outValues(numModulators * MaxOutValues, 0.f)
+		{}
+		float getSumValue(const int pHandle) const noexcept { return hasParameter(pHandle) ? sumValues[pHandle] : 0.f; }
+		float getOutValue(const int mHandle, const int ch) const noexcept {
+			return hasModulator(mHandle) && ch < MaxOutValues ? outValues[mHandle * MaxOutValues + ch] : 0.f;
+		}
+		bool hasParameter(const int pHandle) const noexcept { return pHandle >= 0 && pHandle < sumValues.size(); }
+		bool hasModulator(const int mHandle) const noexcept { return mHandle >= 0 && mHandle < outValues.size() / MaxOutValues; }
+
+		std::vector<float> sumValues;
+		std::vector<float> outValues;
+	};
+
+	/*
+	* lock-free dirty bits, one per parameter and one per modulator handle. the audio thread sets them
+	* when a published value moved past Threshold, edits of the matrix set all of them.
+	* the editor collects and clears them at once and only updates flagged components
+	*/
+	struct ChangeFlags {
+		static constexpr float Threshold = .001f;
+
+		/* the bits of one collect() */
+		struct Set {
+			Set(const int numParams = 0, const size_t numWords = 0) :
+				words(numWords, 0),
+				numParameters(numParams)
+			{}
+			bool any() const noexcept {
+				for (const auto w : words)
+					if (w != 0) return true;
+				return false;
+			}
+			bool hasParameter(const int pHandle) const noexcept { return pHandle >= 0 && pHandle < numParameters && test(pHandle); }
+			bool hasModulator(const int mHandle) const noexcept { return mHandle >= 0 && test(numParameters + mHandle); }
+
+			std::vector<juce::uint64> words;
+			int numParameters;
+		protected:
+			bool test(const int bit) const noexcept {
+				const auto w = static_cast<size_t>(bit) / 64;
+				return w < words.size() && (words[w] >> (bit % 64) & 1) != 0;
+			}
+		};
+
+		ChangeFlags(const int numParameters = 0, const int numModulators = 0) :
+			numParams(numParameters),
+			numBits(numParameters + numModulators),
+			numWords(static_cast<size_t>(numBits + 63) / 64),
+			pending(new std::atomic<juce::uint64>[numWords]),
+			collected(numParameters, numWords),
+			last(numParameters, numModulators)
+		{ setAll(); }
+		void setAll() noexcept {
+			for (auto w = 0; w < numWords; ++w)
+				pending[w].store(~juce::uint64(0), std::memory_order_release);
+		}
+		void setParameter(const int pHandle) noexcept {
+			if (pHandle >= 0 && pHandle < numParams) set(pHandle);
+		}
+		void setModulator(const int mHandle) noexcept {
+			if (mHandle >= 0 && numParams + mHandle < numBits) set(numParams + mHandle);
+		}
+		/* audio thread: flags what differs from the last flagged state of the snapshot */
+		void detect(const UISnapshot& snapshot) noexcept {
+			for (auto p = 0; p < numParams; ++p)
+				if (std::abs(snapshot.sumValues[p] - last.sumValues[p]) > Threshold) {
+					last.sumValues[p] = snapshot.sumValues[p];
+					set(p);
+				}
+			const auto numMods = numBits - numParams;
+			for (auto m = 0; m < numMods; ++m) {
+				auto changed = false;
+				for (auto ch = m * UISnapshot::MaxOutValues; ch < (m + 1) * UISnapshot::MaxOutValues; ++ch)
+					if (std::abs(snapshot.outValues[ch] - last.outValues[ch]) > Threshold) {
+						last.outValues[ch] = snapshot.outValues[ch];
+						changed = true;
+					}
+				if (changed) set(numParams + m);
+			}
+		}
+		/* message thread: takes and clears the pending bits. only call it from one thread */
+		const Set& collect() noexcept {
+			for (auto w = 0; w < numWords; ++w)
+				collected.words[w] = pending[w].load(std::memory_order_relaxed) == 0 ? 0 :
+					pending[w].exchange(0, std::memory_order_acq_rel);
+			return collected;
+		}
+	protected:
+		const int numParams, numBits;
+		const size_t numWords;
+		std::unique_ptr<std::atomic<juce::uint64>[]> pending;
+		Set collected;
+		UISnapshot last; // audio thread only
+
+		void set(const int bit) noexcept {
+			pending[bit / 64].fetch_or(juce::uint64(1) << (bit % 64), std::memory_order_release);
+		}
+	};
+
+	/*
+	* single producer, single consumer ring of min/max pairs of one output channel of a
+	* modulator, one pair per frame length samples. the audio thread pushes, a display pulls.
+	* the display can change channel and frame length at any time, the writer picks them up
+	*/
+	struct ScopeRing {
+		struct Frame { float min, max; };
+		static constexpr int NumFrames = 4096; // twice the widest display
+
+		ScopeRing() :
+			frames(NumFrames),
+			mask(NumFrames - 1),
+			samplesPerFrame(1),
+			channel(0),
+			writePos(0),
+			readPos(0),
+			cur({ 0.f, 0.f }),
+			count(0)
+		{}
+		/* reader. older frames are skipped */
+		void setup(const int ch, const int frameLength) noexcept {
+			channel.store(ch, std::memory_order_relaxed);
+			samplesPerFrame.store(std::max(1, frameLength), std::memory_order_relaxed);
+			readPos = writePos.load(std::memory_order_acquire);
+		}
+		int getChannel() const noexcept { return channel.load(std::memory_order_relaxed); }
+		/* O(numSamples) with vectorized min/max search, never allocates */
+		void push(const float* samples, const int numSamples) noexcept {
+			const auto frameLength = samplesPerFrame.load(std::memory_order_relaxed);
+			auto s = 0;
+			while (s < numSamples) {
+				const auto n = std::min(numSamples - s, std::max(0, frameLength - count));
+				if (n != 0) {
+					const auto range = juce::FloatVectorOperations::findMinAndMax(samples + s, n);
+					if (count == 0)
+						cur = { range.getStart(), range.getEnd() };
+					else
+						cur = { std::min(cur.min, range.getStart()), std::max(cur.max, range.getEnd()) };
+					count += n;
+					s += n;
+				}
+				if (count >= frameLength) {
+					const auto w = writePos.load(std::memory_order_relaxed);
+					frames[w & mask] = cur;
+					writePos.store(w + 1, std::memory_order_release);
+					count = 0;
+				}
+			}
+		}
+		/*
+		* copies the frames written since the last pull to dest, oldest first, and returns how many.
+		* a reader that fell behind only gets the newest half of the ring,
+		* so that the writer doesn't overwrite what's being read
+		*/
+		int pull(Frame* dest, const int maxFrames) noexcept {
+			const auto w = writePos.load(std::memory_order_acquire);
+			const auto maxAvailable = std::min(static_cast<unsigned int>(maxFrames), (mask + 1) / 2);
+			auto r = readPos;
+			if (w - r > maxAvailable)
+				r = w - maxAvailable;
+			const auto numFrames = static_cast<int>(w - r);
+			for (auto f = 0; f < numFrames; ++f)
+				dest[f] = frames[(r + f) & mask];
+			readPos = w;
+			return numFrames;
+		}
+	protected:
+		std::vector<Frame> frames;
+		const unsigned int mask;
+		std::atomic<int> samplesPerFrame, channel;
+		std::atomic<unsigned int> writePos;
+		unsigned int readPos; // reader only
+		Frame cur; // writer only
+		int count; // writer only
+	};
+
+	/*
+	* the scope rings by modulator handle. shared by all copies of the matrix, so showing or
+	* hiding a display never copies it. a ring is made the first time its modulator is shown
+	* and then kept until the table goes, so the audio thread never sees one getting freed.
+	* prepareToPlay makes a new table for the new sample rate, displays then activate again
+	*/
+	struct ScopeTable {
+		ScopeTable(const int numModulators = 0, const double sampleRate = 44100.) :
+			rings(static_cast<size_t>(numModulators)),
+			active(new std::atomic<ScopeRing*>[static_cast<size_t>(numModulators)]),
+			Fs(sampleRate)
+		{
+			for (auto m = 0; m < numModulators; ++m)
+				active[m].store(nullptr, std::memory_order_relaxed);
+		}
+		/* message thread. returns the ring to pull from, nullptr if there's no such modulator */
+		ScopeRing* activate(const int mHandle, const int channel, const double framesPerSecond) {
+			if (mHandle < 0 || mHandle >= rings.size() || framesPerSecond <= 0.) return nullptr;
+			auto& ring = rings[mHandle];
+			if (ring == nullptr) ring = std::make_unique<ScopeRing>();
+			ring->setup(channel, static_cast<int>(Fs / framesPerSecond));
+			active[mHandle].store(ring.get(), std::memory_order_release);
+			return ring.get();
+		}
+		void deactivate(const int mHandle) noexcept {
+			if (mHandle >= 0 && mHandle < rings.size())
+				active[mHandle].store(nullptr, std::memory_order_release);
+		}
+		/* audio thread */
+		ScopeRing* getActive(const int mHandle) const noexcept {
+			return mHandle < rings.size() ? active[mHandle].load(std::memory_order_acquire) : nullptr;
+		}
+	protected:
+		std::vector<std::unique_ptr<ScopeRing>> rings;
+		std::unique_ptr<std::atomic<ScopeRing*>[]> active;
+		const double Fs;
+	};
+
+	/*
+	* history of every parameter's effective value as a min/max pyramid, like a peak file.
+	* level 0 has one entry per block, each further level one per Factor entries of the one below.
+	* every level is a fixed ring, so memory is bounded and lookups at any zoom are O(pixels).
+	* one writer (the audio thread), any number of readers
+	*/
+	struct ParameterHistory {
+		struct Entry { float min, max, last; };
+		static constexpr int NumLevels = 4, Factor = 8;
+
+		ParameterHistory(const int numParams, const int entriesPerLevel) :
+			numParameters(numParams),
+			capacity(juce::nextPowerOfTwo(std::max(entriesPerLevel, 2))),
+			entries(static_cast<size_t>(NumLevels * capacity * numParams)),
+			accumulators(static_cast<size_t>(NumLevels * numParams)),
+			writePos(),
+			counts()
+		{
+			for (auto& w : writePos) w.store(0);
+			counts.fill(0);
+		}
+		/* appends this block's min/max/last of each (limited) active parameter block. entries of inactive ones are meaningless */
+		void push(const std::vector<std::shared_ptr<Parameter>>& parameters, const std::vector<int>& activeHandles, const int numSamples) noexcept {
+			const auto numParams = std::min(numParameters, static_cast<int>(parameters.size()));
+			auto level0 = getEntries(0, writePos[0].load(std::memory_order_relaxed));
+			for (const auto p : activeHandles) {
+				if (p >= numParams) break;
+				const auto data = parameters[p]->data().data();
+				const auto range = juce::FloatVectorOperations::findMinAndMax(data, numSamples);
+				level0[p] = { range.getStart(), range.getEnd(), data[numSamples - 1] };
+			}
+			writePos[0].fetch_add(1, std::memory_order_release);
+			for (auto l = 1; l < NumLevels; ++l) {
+				const auto below = getEntries(l - 1, writePos[l - 1].load(std::memory_order_relaxed) - 1);
+				auto acc = &accumulators[l * numParameters];
+				for (const auto p : activeHandles) {
+					if (p >= numParams) break;
+					acc[p] = counts[l] == 0 ? below[p] : Entry{
+						std::min(acc[p].min, below[p].min), std::max(acc[p].max, below[p].max), below[p].last };
+				}
+				if (++counts[l] != Factor) return;
+				counts[l] = 0;
+				std::copy(acc, acc + numParams, getEntries(l, writePos[l].load(std::memory_order_relaxed)));
+				writePos[l].fetch_add(1, std::memory_order_release);
+			}
+		}
+		/*
+		* fills dest with numColumns entries of a parameter that cover the last numBlocks blocks,
+		* oldest first. reads the coarsest level that still has an entry per column.
+		* returns the number of blocks actually covered, 0 if there's nothing yet
+		*/
+		int read(const int pHandle, const int numBlocks, Entry* dest, const int numColumns) const noexcept {
+			if (pHandle < 0 || pHandle >= numParameters || numColumns < 1) return 0;
+			auto level = 0;
+			auto blocksPerEntry = 1;
+			while (level < NumLevels - 1 && numBlocks / (blocksPerEntry * Factor) >= numColumns) {
+				++level;
+				blocksPerEntry *= Factor;
+			}
+			for (auto attempt = 0; attempt < 2; ++attempt) {
+				const auto w = writePos[level].load(std::memory_order_acquire);
+				const auto available = std::min(w, static_cast<unsigned int>(capacity - 1));
+				const auto numEntries = std::min(static_cast<unsigned int>((numBlocks + blocksPerEntry - 1) / blocksPerEntry), available);
+				if (numEntries == 0) return 0;
+				const auto start = w - numEntries;
+				for (auto c = 0; c < numColumns; ++c) {
+					const auto first = start + static_cast<unsigned int>(c * numEntries / numColumns);
+					const auto last = std::max(first + 1, start + static_cast<unsigned int>((c + 1) * numEntries / numColumns));
+					auto e = getEntries(level, first)[pHandle];
+					for (auto i = first + 1; i < last; ++i) {
+						const auto& next = getEntries(level, i)[pHandle];
+						e = { std::min(e.min, next.min), std::max(e.max, next.max), next.last };
+					}
+					dest[c] = e;
+				}
+				// entries the writer reached while they were read are torn, so read again
+				if (writePos[level].load(std::memory_order_acquire) - start < static_cast<unsigned int>(capacity))
+					return static_cast<int>(numEntries) * blocksPerEntry;
+			}
+			return 0;
+		}
+	protected:
+		const int numParameters, capacity;
+		std::vector<Entry> entries; // [level][entry][parameter]
+		std::vector<Entry> accumulators; // [level][parameter], writer only
+		std::array<std::atomic<unsigned int>, NumLevels> writePos;
+		std::array<int, NumLevels> counts; // writer only, entries of the level below in accumulators[level]
+
+		Entry* getEntries(const int level, const unsigned int pos) noexcept {
+			return &entries[(static_cast<size_t>(level) * capacity + (pos & (capacity - 1))) * numParameters];
+		}
+		const Entry* getEntries(const int level, const unsigned int pos) const noexcept {
+			return &entries[(static_cast<size_t>(level) * capacity + (pos & (capacity - 1))) * numParameters];
+		}
+	};
+
+	/*
+	* the parameter history, shared by all copies of the matrix like the scope table.
+	* it's made when the first view opens and then kept until the gate goes, so the audio thread
+	* never sees it getting freed, but it's only captured while a view is open. blocks while
+	* all views were closed are missing from it. prepareToPlay makes a new gate, views then open again
+	*/
+	struct ParameterHistoryGate {
+		static constexpr int EntriesPerLevel = 256;
+
+		ParameterHistoryGate(const int numParams = 0) :
+			numParameters(numParams),
+			history(),
+			active(nullptr),
+			numViews(0)
+		{}
+		/* message thread. returns the history to read from, nullptr if there are no parameters */
+		const ParameterHistory* open() {
+			if (numParameters == 0) return nullptr;
+			if (history == nullptr) history = std::make_unique<ParameterHistory>(numParameters, EntriesPerLevel);
+			++numViews;
+			active.store(history.get(), std::memory_order_release);
+			return history.get();
+		}
+		void close() noexcept {
+			if (numViews == 0 || --numViews != 0) return;
+			active.store(nullptr, std::memory_order_release);
+		}
+		/* audio thread */
+		ParameterHistory* getActive() const noexcept { return active.load(std::memory_order_acquire); }
+	protected:
+		const int numParameters;
+		std::unique_ptr<ParameterHistory> history;
+		std::atomic<ParameterHistory*> active;
+		int numViews; // message thread only
+	};
+
+	/*
+	* helpers for the compact binary state. counts and handles are varints, attenuvertors
+	* are 16 bit or raw floats depending on the header's flags, and each destination's
+	* bidirectional flag and channel setup share one byte
+	*/
+	struct BinaryState {
+		static constexpr int Magic = 0x5359534d; // "MSYS"
+		static constexpr int Version = 3;
+		static constexpr int MinVersion = 3; // 1 stored the parameters by position, 2 a hash of the routings' layout
+		enum Flags { QuantizedAttenuvertors = 1 };
+
+		static void writeHeader(juce::OutputStream& out, const int flags) {
+			out.writeInt(Magic);
+			out.writeByte(static_cast<char>(Version));
+			out.writeByte(static_cast<char>(flags));
+		}
+		/* false for everything else, like the xml of older sessions */
+		static bool isBinaryState(const void* data, const int sizeInBytes) noexcept {
+			return sizeInBytes >= 6 && juce::ByteOrder::littleEndianInt(data) == Magic;
+		}
+		/* returns the flags, or -1 if there is no header or it's from an unsupported version */
+		static int readHeader(juce::InputStream& in) {
+			if (in.readInt() != Magic) return -1;
+			const auto version = static_cast<unsigned char>(in.readByte());
+			if (version < MinVersion || version > Version) return -1;
+			return static_cast<unsigned char>(in.readByte());
+		}
+		static void writeVarInt(juce::OutputStream& out, const int value) {
+			auto v = static_cast<unsigned int>(value);
+			while (v >= 0x80) {
+				out.writeByte(static_cast<char>((v & 0x7f) | 0x80));
+				v >>= 7;
+			}
+			out.writeByte(static_cast<char>(v));
+		}
+		/* -1 if the stream is exhausted, so cut off counts and handles fail their range checks */
+		static int readVarInt(juce::InputStream& in) {
+			if (in.isExhausted()) return -1;
+			unsigned int v = 0;
+			for (auto shift = 0; shift < 32; shift += 7) {
+				const auto b = static_cast<unsigned char>(in.readByte());
+				v |= static_cast<unsigned int>(b & 0x7f) << shift;
+				if ((b & 0x80) == 0) break;
+			}
+			return static_cast<int>(v);
+		}
+		/* sections are prefixed with their size, so truncated ones can be told apart */
+		static void writeSection(juce::OutputStream& out, const juce::MemoryBlock& section) {
+			writeVarInt(out, static_cast<int>(section.getSize()));
+			out.write(section.getData(), section.getSize());
+		}
+		/* false if the stream ends before the section does */
+		static bool readSection(juce::InputStream& in, juce::MemoryBlock& section) {
+			const auto size = readVarInt(in);
+			if (size < 0 || in.getNumBytesRemaining() < size) return false;
+			section.setSize(static_cast<size_t>(size));
+			return in.read(section.getData(), size) == size;
+		}
+		static void writeAttenuvertor(juce::OutputStream& out, const float value, const int flags) {
+			if (flags & QuantizedAttenuvertors)
+				out.writeShort(static_cast<short>(std::rint(juce::jlimit(-1.f, 1.f, value) * 32767.f)));
+			else
+				out.writeFloat(value);
+		}
+		static int getAttenuvertorSize(const int flags) noexcept {
+			return flags & QuantizedAttenuvertors ? 2 : 4;
+		}
+		static float readAttenuvertor(juce::InputStream& in, const int flags) {
+			if (flags & QuantizedAttenuvertors)
+				return static_cast<float>(in.readShort()) / 32767.f;
+			return in.readFloat();
+		}
+		/* the top bit says a bias follows the attenuvertor. older states never set it */
+		static char packDestination(const bool bidirec, const ChannelSetup channelSetup, const bool hasBias = false) noexcept {
+			return static_cast<char>((bidirec ? 1 : 0) | (static_cast<int>(channelSetup) << 1) | (hasBias ? 0x80 : 0));
+		}
+		static bool isBidirectional(const char packed) noexcept { return (packed & 1) != 0; }
+		static bool hasBias(const char packed) noexcept { return (packed & 0x80) != 0; }
+		static ChannelSetup getChannelSetup(const char packed) noexcept {
+			return static_cast<ChannelSetup>((static_cast<unsigned char>(packed) >> 1) & 0x3f);
+		}
+	};
+
+	/*
+	* what the handles of a routing section refer to: the parameter and modulator ids and the
+	* slot type names in handle order. it's written in front of the routings, so a state can be
+	* read by a layout with added, removed or reordered ids (see RoutingState::read)
+	*/
+	struct RoutingLayout {
+		RoutingLayout() :
+			parameters(),
+			modulators(),
+			slotTypes()
+		{}
+		void write(juce::OutputStream& out) const {
+			writeIDs(out, parameters);
+			writeIDs(out, modulators);
+			writeIDs(out, slotTypes);
+		}
+		/*
+		* reads a table written by write and maps each of its entries to the handle of the same id
+		* in ids, or -1 if there is none. false if the stream ends before the table does
+		*/
+		static bool readHandles(juce::InputStream& in, const std::vector<juce::String>& ids, std::vector<int>& handles) {
+			const auto num = BinaryState::readVarInt(in);
+			// every id takes at least a byte, which bounds the table before it gets allocated
+			if (num < 0 || num > in.getNumBytesRemaining()) return false;
+			std::map<juce::String, int> handleOf;
+			for (auto h = 0; h < ids.size(); ++h)
+				handleOf.emplace(ids[h], h);
+			handles.resize(num);
+			for (auto& h : handles) {
+				if (in.isExhausted()) return false;
+				const auto it = handleOf.find(in.readString());
+				h = it != handleOf.end() ? it->second : -1;
+			}
+			return true;
+		}
+
+		std::vector<juce::String> parameters, modulators, slotTypes;
+	private:
+		static void writeIDs(juce::OutputStream& out, const std::vector<juce::String>& ids) {
+			BinaryState::writeVarInt(out, static_cast<int>(ids.size()));
+			for (const auto& id : ids)
+				out.writeString(id);
+		}
+	};
+
+	/*
+	* the routing section of a binary state, decoded without touching a matrix.
+	* lets a state get read on any thread and then applied as a diff (Matrix::applyState)
+	*/
+	struct RoutingState {
+		struct Dest { int handle; ChannelSetup channelSetup; bool bidirec; float atten, bias; };
+		struct Mod { int handle, inputBus; std::vector<Dest> dests; };
+
+		RoutingState() :
+			slotTypes(),
+			modulators()
+		{}
+		/*
+		* maps the state's handles to the ones of layout by their ids. modulators, destinations and
+		* slot types whose ids layout doesn't have are dropped, slots beyond numSlots too.
+		* returns false if the stream ended early or its counts don't fit its tables.
+		* such a state is incomplete and must not be applied
+		*/
+		bool read(juce::InputStream& in, const int flags, const RoutingLayout& layout, const int numSlots) {
+			std::vector<int> params, mods, types;
+			if (!RoutingLayout::readHandles(in, layout.parameters, params)
+				|| !RoutingLayout::readHandles(in, layout.modulators, mods)
+				|| !RoutingLayout::readHandles(in, layout.slotTypes, types))
+				return false;
+			const auto numStoredSlots = BinaryState::readVarInt(in);
+			if (numStoredSlots < 0 || numStoredSlots > mods.size()) return false;
+			slotTypes.assign(juce::jmin(numStoredSlots, numSlots), -1);
+			for (auto s = 0; s < numStoredSlots; ++s) {
+				const auto t = BinaryState::readVarInt(in) - 1;
+				if (t < -1 || t >= static_cast<int>(types.size())) return false;
+				if (s < slotTypes.size() && t != -1)
+					slotTypes[s] = types[t];
+			}
+			const auto numModulators = BinaryState::readVarInt(in);
+			if (numModulators < 0 || numModulators > mods.size()) return false;
+			for (auto m = 0; m < numModulators; ++m) {
+				const auto mHandle = BinaryState::readVarInt(in);
+				const auto inputBus = BinaryState::readVarInt(in);
+				const auto numDests = BinaryState::readVarInt(in);
+				if (mHandle < 0 || mHandle >= mods.size() || inputBus < 0 || numDests < 0 || numDests > params.size()) return false;
+				Mod mod{ mods[mHandle], inputBus, {} };
+				for (auto d = 0; d < numDests; ++d) {
+					const auto pHandle = BinaryState::readVarInt(in);
+					if (in.isExhausted()) return false;
+					const auto packed = in.readByte();
+					const auto numAttenuvertors = BinaryState::hasBias(packed) ? 2 : 1;
+					if (in.getNumBytesRemaining() < numAttenuvertors * BinaryState::getAttenuvertorSize(flags)) return false;
+					const auto atten = BinaryState::readAttenuvertor(in, flags);
+					const auto bias = BinaryState::hasBias(packed) ? BinaryState::readAttenuvertor(in, flags) : Destination::LinearBias;
+					if (pHandle < 0 || pHandle >= params.size()) return false;
+					if (params[pHandle] != -1)
+						mod.dests.push_back({ params[pHandle], BinaryState::getChannelSetup(packed), BinaryState::isBidirectional(packed), atten, bias });
+				}
+				if (mod.handle != -1)
+					modulators.push_back(std::move(mod));
+			}
+			return true;
+		}
+
+		std::vector<int> slotTypes; // -1 = empty
+		std::vector<Mod> modulators;
+	};
+
+	/*
+	* the gains of the matrix' global stage: one lane for the macros' modulation, one for the other
+	* modulators' and a scratch lane, and tables that point each parameter to its gain lanes.
+	* only the copy the audio thread processes touches it, so it's shared by all copies of the matrix
+	* instead of getting copied with them
+	*/
+	struct GlobalStageLanes {
+		enum { MacroGain, ModulesGain, Scratch, NumLanes };
+
+		GlobalStageLanes(const int numParameters = 0, const int blockSize = 0, const int depthHandle = -1, const int modulesMixHandle = -1) :
+			gains(numParameters != 0 ? NumLanes : 0, blockSize),
+			macros(static_cast<size_t>(numParameters), numParameters != 0 ? gains.getReadPointer(MacroGain) : nullptr),
+			modules(static_cast<size_t>(numParameters), numParameters != 0 ? gains.getReadPointer(ModulesGain) : nullptr)
+		{
+			// depth and modules mix aren't scaled themselves
+			for (const auto p : { depthHandle, modulesMixHandle })
+				if (p >= 0 && p < numParameters)
+					macros[p] = modules[p] = nullptr;
+		}
+		juce::AudioBuffer<float> gains;
+		std::vector<const float*> macros, modules; // by parameter handle
+	};
+
 	/*
 	* the thing that handles everything in the end
 	*/
@@ -973,27 +2365,97 @@ namespace modSys2 {
 		Matrix(juce::AudioProcessorValueTreeState& apvts) :
 			parameters(),
 			modulators(),
+			modulatorsByHandle(),
+			destinations(),
+			parameterOwner(),
+			activeParameters(),
 			curPosInfo(getDefaultPlayHead()),
 			block(),
-			selectedModulator()
+			selectedModulator(),
+			maxBlockSize(0),
+			slotPool(),
+			slotTypes(),
+			preparedChannels(0),
+			Fs(1.),
+			generation(std::make_shared<juce::Atomic<int>>(0)),
+			revision(0),
+			snapshots(std::make_shared<TripleBuffer<UISnapshot>>(UISnapshot())),
+			changes(std::make_shared<ChangeFlags>()),
+			scopes(std::make_shared<ScopeTable>()),
+			history(std::make_shared<ParameterHistoryGate>()),
+			depthHandle(-1),
+			modulesMixHandle(-1),
+			isMacro(),
+			lanes(std::make_shared<GlobalStageLanes>())
 		{
 			const Type type;
 			auto& state = apvts.state;
 			const auto numChildren = state.getNumChildren();
 			for (auto c = 0; c < numChildren; ++c) {
 				const auto& pChild = apvts.state.getChild(c);
-				if (pChild.hasType(type.param)) {
-					const auto pID = pChild.getProperty(type.id).toString();
-					parameters.push_back(std::make_shared<Parameter>(apvts, pID));
-				}
+				if (pChild.hasType(type.param))
+					addParameter(apvts, pChild.getProperty(type.id).toString());
 			}
+			parameterOwner.assign(parameters.size(), -1);
+			updateActiveParameters();
+		}
+		/* creates the parameters in the given order, so that each handle is its index in pIDs */
+		Matrix(juce::AudioProcessorValueTreeState& apvts, const juce::StringArray& pIDs) :
+			parameters(),
+			modulators(),
+			modulatorsByHandle(),
+			destinations(),
+			parameterOwner(),
+			activeParameters(),
+			curPosInfo(getDefaultPlayHead()),
+			block(),
+			selectedModulator(),
+			maxBlockSize(0),
+			slotPool(),
+			slotTypes(),
+			preparedChannels(0),
+			Fs(1.),
+			generation(std::make_shared<juce::Atomic<int>>(0)),
+			revision(0),
+			snapshots(std::make_shared<TripleBuffer<UISnapshot>>(UISnapshot())),
+			changes(std::make_shared<ChangeFlags>()),
+			scopes(std::make_shared<ScopeTable>()),
+			history(std::make_shared<ParameterHistoryGate>()),
+			depthHandle(-1),
+			modulesMixHandle(-1),
+			isMacro(),
+			lanes(std::make_shared<GlobalStageLanes>())
+		{
+			for (const auto& pID : pIDs)
+				addParameter(apvts, pID);
+			parameterOwner.assign(parameters.size(), -1);
+			updateActiveParameters();
 		}
 		Matrix(const Matrix& other) :
 			parameters(other.parameters),
 			modulators(other.modulators),
+			modulatorsByHandle(other.modulatorsByHandle),
+			destinations(other.destinations),
+			parameterOwner(other.parameterOwner),
+			activeParameters(other.activeParameters),
 			curPosInfo(getDefaultPlayHead()),
 			block(other.block),
-			selectedModulator(other.selectedModulator)
+			selectedModulator(other.selectedModulator),
+			maxBlockSize(other.maxBlockSize),
+			slotPool(other.slotPool),
+			slotTypes(other.slotTypes),
+			preparedChannels(other.preparedChannels),
+			Fs(other.Fs),
+			generation(other.generation),
+			revision(other.revision),
+			snapshots(other.snapshots),
+			changes(other.changes),
+			scopes(other.scopes),
+			history(other.history),
+			depthHandle(other.depthHandle),
+			modulesMixHandle(other.modulesMixHandle),
+			isMacro(other.isMacro),
+			lanes(other.lanes)
 		{}
 		// SET
 		void prepareToPlay(const int numChannels, const int blockSize, const double sampleRate) {
@@ -1001,23 +2463,94 @@ namespace modSys2 {
 				p->prepareToPlay(blockSize, sampleRate);
 			for (auto& m : modulators)
 				m->prepareToPlay(numChannels, sampleRate);
-			const auto channelCount = numChannels * numChannels;
+			auto channelCount = numChannels * numChannels;
+			for (const auto& m : modulators)
+				channelCount = std::max(channelCount, m->getNumOutputChannels(numChannels));
+			if (slotPool != nullptr)
+				for (const auto& slot : slotPool->getModulators())
+					for (const auto& m : slot)
+						if (m != nullptr) {
+							m->prepareToPlay(numChannels, sampleRate);
+							channelCount = std::max(channelCount, m->getNumOutputChannels(numChannels));
+						}
 			block.setSize(channelCount, blockSize, false, false, false);
+			lanes = std::make_shared<GlobalStageLanes>(depthHandle != -1 ? static_cast<int>(parameters.size()) : 0, blockSize,
+				depthHandle, modulesMixHandle);
+			maxBlockSize = blockSize;
+			preparedChannels = numChannels;
+			Fs = sampleRate;
+			snapshots = std::make_shared<TripleBuffer<UISnapshot>>(UISnapshot(
+				static_cast<int>(parameters.size()), static_cast<int>(modulatorsByHandle.size())));
+			changes = std::make_shared<ChangeFlags>(
+				static_cast<int>(parameters.size()), static_cast<int>(modulatorsByHandle.size()));
+			scopes = std::make_shared<ScopeTable>(static_cast<int>(modulatorsByHandle.size()), sampleRate);
+			history = std::make_shared<ParameterHistoryGate>(static_cast<int>(parameters.size()));
+		}
+		/*
+		* parameters that shape all modulation after the routing. depth scales each parameter's
+		* modulation, modules mix fades from only the macros (0) over both (.5) to only the other modulators (1)
+		*/
+		void setGlobalParameters(const int depthPHandle, const int modulesMixPHandle) noexcept {
+			depthHandle = getParameter(depthPHandle) != nullptr ? depthPHandle : -1;
+			modulesMixHandle = getParameter(modulesMixPHandle) != nullptr ? modulesMixPHandle : -1;
+			if (modulesMixHandle == -1) depthHandle = -1;
 		}
 		void setSmoothingLengthInSamples(const juce::Identifier& pID, float length) noexcept {
-			getParameter(pID)->setSmoothingLengthInSamples(length);
-		}
+			setSmoothingLengthInSamples(getParameterHandle(pID), length);
+		}
+		void setSmoothingLengthInSamples(const int pHandle, float length) noexcept {
+			if (auto p = getParameter(pHandle))
+				p->setSmoothingLengthInSamples(length);
+		}
+		int getLatencySamples() const noexcept {
+			auto latency = 0;
+			for (const auto& m : modulators)
+				latency = std::max(latency, m->getLatencySamples());
+			return latency;
+		}
+		/*
+		* stamps this copy with a generation no other edit of any copy got, so the state only
+		* has to be serialized again if the generation of the copy it's taken from changed.
+		* also flags everything for the editor
+		*/
+		void markModified() noexcept {
+			revision = ++(*generation);
+			changes->setAll();
+		}
+		/* for edits that only touch one modulator and/or parameter */
+		void markModified(const int mHandle, const int pHandle) noexcept {
+			revision = ++(*generation);
+			changes->setModulator(mHandle);
+			changes->setParameter(pHandle);
+		}
+		/* the generation of this copy's last edit */
+		int getGeneration() const noexcept { return revision; }
 		// SERIALIZE
 		void setState(juce::AudioProcessorValueTreeState& apvts) {
+			markModified();
 			// BINARY TO VALUETREE
 			auto& state = apvts.state;
 			const Type type;
 			auto modSysChild = state.getChildWithName(type.modSys);
 			if (!modSysChild.isValid()) return;
+			if (slotPool != nullptr) {
+				const auto slotsChild = modSysChild.getChildWithName(type.slots);
+				for (auto s = 0; s < getNumSlots(); ++s) {
+					const auto slotChild = slotsChild.getChildWithProperty(type.id, s);
+					const auto t = slotChild.isValid() ? slotPool->getTypeIndex(slotChild.getProperty(type.slot).toString()) : -1;
+					if (t == -1)
+						freeSlot(s);
+					else
+						setSlot(s, t);
+				}
+			}
 			auto numModulators = modSysChild.getNumChildren();
 			for (auto m = 0; m < numModulators; ++m) {
 				const auto modChild = modSysChild.getChild(m);
+				if (!modChild.hasType(type.modulator)) continue;
 				const auto mID = modChild.getProperty(type.id).toString();
+				if (const auto mod = getModulator(mID))
+					mod->setInputBus(static_cast<int>(modChild.getProperty(type.inputBus, 0)));
 				const auto numDestinations = modChild.getNumChildren();
 				for (auto d = 0; d < numDestinations; ++d) {
 					const auto destChild = modChild.getChild(d);
@@ -1026,8 +2559,12 @@ namespace modSys2 {
 					const auto bidirec = destChild.getProperty(type.bidirec).toString() == "0" ? false : true;
 					const auto destParameter = getParameter(dID);
 					const auto channelSetup = static_cast<ChannelSetup>(static_cast<int>(destChild.getProperty(type.channelSetup, ChannelSetup::Left)));
-					if(destParameter != nullptr)
+					if (destParameter != nullptr) {
 						addDestination(mID, dID, channelSetup, dValue, bidirec);
+						const auto bias = static_cast<float>(destChild.getProperty(type.bias, Destination::LinearBias));
+						if (const auto dest = getDestination(getModulatorHandle(mID), destParameter->handle))
+							dest->setBias(bias);
+					}
 					// what if destination not parameter??
 					// should non-parameter destinations be serializable?
 				}
@@ -1044,14 +2581,29 @@ namespace modSys2 {
 			}
 			modSysChild.removeAllChildren(nullptr);
 
+			if (slotPool != nullptr) {
+				juce::ValueTree slotsChild(type.slots);
+				for (auto s = 0; s < getNumSlots(); ++s)
+					if (slotTypes[s] != -1) {
+						juce::ValueTree slotChild(type.slot);
+						slotChild.setProperty(type.id, s, nullptr);
+						slotChild.setProperty(type.slot, slotPool->getType(slotTypes[s]).name, nullptr);
+						slotsChild.appendChild(slotChild, nullptr);
+					}
+				modSysChild.appendChild(slotsChild, nullptr);
+			}
 			for (const auto& mod : modulators) {
 				juce::ValueTree modChild(type.modulator);
 				modChild.setProperty(type.id, mod->id.toString(), nullptr);
-				const auto& destVec = mod->getDestinations();
+				if (mod->acceptsAudio())
+					modChild.setProperty(type.inputBus, mod->getInputBus(), nullptr);
+				const auto& destVec = getDestinations(mod->handle);
 				for (const auto d : destVec) {
 					juce::ValueTree destChild(type.destination);
 					destChild.setProperty(type.id, d->id.toString(), nullptr);
 					destChild.setProperty(type.atten, d->getValue(), nullptr);
+					if (d->getBias() != Destination::LinearBias)
+						destChild.setProperty(type.bias, d->getBias(), nullptr);
 					destChild.setProperty(type.bidirec, d->isBidirectional() ? 1 : 0, nullptr);
 					destChild.setProperty(type.channelSetup, static_cast<int>(d->getChannelSetup()), nullptr);
 					modChild.appendChild(destChild, nullptr);
@@ -1059,22 +2611,149 @@ namespace modSys2 {
 				modSysChild.appendChild(modChild, nullptr);
 			}
 		}
+		/* the ids the handles of the routing section refer to, see RoutingLayout */
+		RoutingLayout getLayout() const {
+			RoutingLayout layout;
+			for (const auto& p : parameters)
+				layout.parameters.push_back(p->id.toString());
+			for (auto h = 0; h < modulatorsByHandle.size(); ++h) {
+				const auto slot = slotPool != nullptr ? h - slotPool->getModulatorHandle(0) : -1;
+				if (slot >= 0 && slot < slotPool->getNumSlots())
+					layout.modulators.push_back(slotPool->getModulatorID(slot));
+				else
+					layout.modulators.push_back(modulatorsByHandle[h]->id.toString());
+			}
+			if (slotPool != nullptr)
+				for (auto t = 0; t < slotPool->getNumTypes(); ++t)
+					layout.slotTypes.push_back(slotPool->getType(t).name);
+			return layout;
+		}
+		/*
+		* routing section of the binary state: the layout and slot types, then per modulator
+		* in processing order its input bus and parameter destinations
+		*/
+		void writeState(juce::OutputStream& out, const int flags) const {
+			getLayout().write(out);
+			BinaryState::writeVarInt(out, getNumSlots());
+			for (const auto t : slotTypes)
+				BinaryState::writeVarInt(out, t + 1);
+			BinaryState::writeVarInt(out, static_cast<int>(modulators.size()));
+			for (const auto& mod : modulators) {
+				BinaryState::writeVarInt(out, mod->handle);
+				BinaryState::writeVarInt(out, mod->getInputBus());
+				const auto& destVec = getDestinations(mod->handle);
+				auto numParamDests = 0;
+				for (const auto& d : destVec)
+					if (d->handle != -1)
+						++numParamDests;
+				BinaryState::writeVarInt(out, numParamDests);
+				for (const auto& d : destVec) {
+					if (d->handle == -1) continue;
+					BinaryState::writeVarInt(out, d->handle);
+					const auto hasBias = d->getBias() != Destination::LinearBias;
+					out.writeByte(BinaryState::packDestination(d->isBidirectional(), d->getChannelSetup(), hasBias));
+					BinaryState::writeAttenuvertor(out, d->getValue(), flags);
+					if (hasBias)
+						BinaryState::writeAttenuvertor(out, d->getBias(), flags);
+				}
+			}
+		}
+		/*
+		* replaces all routings with the ones written by writeState. returns false and leaves
+		* the routings alone if the stream ended early or is malformed
+		*/
+		bool readState(juce::InputStream& in, const int flags) {
+			RoutingState state;
+			if (!state.read(in, flags, getLayout(), getNumSlots())) return false;
+			applyState(state);
+			return true;
+		}
+		/* makes the routings equal to state by only touching what differs */
+		void applyState(const RoutingState& state) {
+			applySlots(state);
+			applyRoutings(state);
+		}
+		/* the slots' modulators are pooled and shared by all copies, so this belongs on the message thread */
+		void applySlots(const RoutingState& state) {
+			for (auto s = 0; s < state.slotTypes.size() && s < getNumSlots(); ++s)
+				if (state.slotTypes[s] != slotTypes[s]) {
+					if (state.slotTypes[s] == -1) freeSlot(s);
+					else setSlot(s, state.slotTypes[s]);
+				}
+		}
+		/*
+		* destinations that are missing or have another channel setup get removed,
+		* changed ones get updated in place and new ones get added. this only replaces
+		* lists of this copy (see editDestinations), so a copy nobody else holds can be
+		* brought up to date on any thread
+		*/
+		void applyRoutings(const RoutingState& state) {
+			std::vector<const RoutingState::Dest*> wanted(parameters.size(), nullptr);
+			std::vector<bool> isInState(modulatorsByHandle.size(), false);
+			for (const auto& m : state.modulators) {
+				const auto mod = getModulator(m.handle);
+				if (mod == nullptr) continue;
+				isInState[m.handle] = true;
+				if (mod->getInputBus() != m.inputBus)
+					setInputBus(m.handle, m.inputBus);
+				for (const auto& d : m.dests)
+					if (d.handle >= 0 && d.handle < wanted.size())
+						wanted[d.handle] = &d;
+				removeUnwantedDestinations(m.handle, wanted);
+				for (const auto& d : m.dests) {
+					if (d.handle < 0 || d.handle >= wanted.size()) continue;
+					wanted[d.handle] = nullptr;
+					const auto dest = getDestination(m.handle, d.handle);
+					if (dest == nullptr)
+						addDestination(m.handle, d.handle, d.channelSetup, d.atten, d.bidirec);
+					else {
+						if (dest->getValue() != d.atten)
+							setAttenuvertor(m.handle, d.handle, d.atten);
+						if (dest->isBidirectional() != d.bidirec)
+							setBidirectional(m.handle, d.handle, d.bidirec);
+					}
+					if (const auto added = getDestination(m.handle, d.handle))
+						if (added->getBias() != d.bias)
+							setBias(m.handle, d.handle, d.bias);
+				}
+			}
+			for (const auto& mod : modulators)
+				if (!isInState[mod->handle])
+					removeUnwantedDestinations(mod->handle, wanted);
+		}
 		// ADD MODULATORS
 		std::shared_ptr<Modulator> addMacroModulator(const juce::Identifier& pID) {
-			modulators.push_back(std::make_shared<MacroModulator>(getParameter(pID)));
-			return modulators[modulators.size() - 1];
+			return addModulator(std::make_shared<MacroModulator>(getParameter(pID)));
 		}
 		std::shared_ptr<Modulator> addEnvelopeFollowerModulator(const juce::Identifier& gainPID,
 			const juce::Identifier& atkPID, const juce::Identifier& rlsPID,
-			const juce::Identifier& biasPID, const juce::Identifier& wdthPID, int idx) {
+			const juce::Identifier& biasPID, const juce::Identifier& wdthPID,
+			const juce::Identifier& detectorPID, const juce::Identifier& windowPID,
+			const juce::Identifier& lookaheadPID, const juce::Identifier& decimationPID, int idx) {
 			const auto gainP = getParameter(gainPID);
 			const auto atkP = getParameter(atkPID);
 			const auto rlsP = getParameter(rlsPID);
 			const auto biasP = getParameter(biasPID);
 			const auto wdthP = getParameter(wdthPID);
+			const auto detectorP = getParameter(detectorPID);
+			const auto windowP = getParameter(windowPID);
+			const auto lookaheadP = getParameter(lookaheadPID);
+			const auto decimationP = getParameter(decimationPID);
 			const juce::String idString("EnvFol" + static_cast<juce::String>(idx));
-			modulators.push_back(std::make_shared<EnvelopeFollowerModulator>(idString, gainP, atkP, rlsP, biasP, wdthP));
-			return modulators[modulators.size() - 1];
+			return addModulator(std::make_shared<EnvelopeFollowerModulator>(idString, gainP, atkP, rlsP, biasP, wdthP,
+				detectorP, windowP, lookaheadP, decimationP));
+		}
+		std::shared_ptr<Modulator> addMultibandEnvelopeFollowerModulator(const juce::Identifier& gainPID,
+			const juce::Identifier& atkPID, const juce::Identifier& rlsPID,
+			const juce::Identifier& xLowPID, const juce::Identifier& xMidPID, const juce::Identifier& xHighPID, int idx) {
+			const auto gainP = getParameter(gainPID);
+			const auto atkP = getParameter(atkPID);
+			const auto rlsP = getParameter(rlsPID);
+			const auto xLowP = getParameter(xLowPID);
+			const auto xMidP = getParameter(xMidPID);
+			const auto xHighP = getParameter(xHighPID);
+			const juce::String idString("MBEnvFol" + static_cast<juce::String>(idx));
+			return addModulator(std::make_shared<MultibandEnvelopeFollowerModulator>(idString, gainP, atkP, rlsP, xLowP, xMidP, xHighP));
 		}
 		std::shared_ptr<Modulator> addLFOModulator(const juce::Identifier& syncPID, const juce::Identifier& ratePID,
 			const juce::Identifier& wdthPID, const juce::Identifier& waveTablePID,
@@ -1084,8 +2763,7 @@ namespace modSys2 {
 			const auto wdthP = getParameter(wdthPID);
 			const auto waveTableP = getParameter(waveTablePID);
 			const juce::String idString("LFO" + static_cast<juce::String>(idx));
-			modulators.push_back(std::make_shared<LFOModulator>(idString, syncP, rateP, wdthP, waveTableP, ranges));
-			return modulators[modulators.size() - 1];
+			return addModulator(std::make_shared<LFOModulator>(idString, syncP, rateP, wdthP, waveTableP, ranges));
 		}
 		std::shared_ptr<Modulator> addRandomModulator(const juce::Identifier& syncPID, const juce::Identifier& ratePID,
 			const juce::Identifier& biasPID, const juce::Identifier& widthPID, const juce::Identifier& smoothPID,
@@ -1096,112 +2774,404 @@ namespace modSys2 {
 			const auto widthP = getParameter(widthPID);
 			const auto smoothP = getParameter(smoothPID);
 			const juce::String idString("Rand" + static_cast<juce::String>(idx));
-			modulators.push_back(std::make_shared<RandomModulator>(idString, syncP, rateP, biasP, widthP, smoothP, ranges));
-			return modulators[modulators.size() - 1];
+			return addModulator(std::make_shared<RandomModulator>(idString, syncP, rateP, biasP, widthP, smoothP, ranges));
 		}
 		std::shared_ptr<Modulator> addPerlinModulator(const juce::Identifier& syncPID, const juce::Identifier& ratePID,
-			const juce::Identifier& octavesPID, const juce::Identifier& widthPID,
+			const juce::Identifier& octavesPID, const juce::Identifier& widthPID, const juce::Identifier& noisePID,
 			const param::MultiRange& ranges, int maxOctaves, int idx) {
 			const auto syncP = getParameter(syncPID);
 			const auto rateP = getParameter(ratePID);
 			const auto octavesP = getParameter(octavesPID);
 			const auto widthP = getParameter(widthPID);
+			const auto noiseP = getParameter(noisePID);
 			const juce::String idString("Perlin" + static_cast<juce::String>(idx));
-			modulators.push_back(std::make_shared<PerlinModulator>(idString, syncP, rateP, octavesP, widthP, ranges, maxOctaves));
-			return modulators[modulators.size() - 1];
+			return addModulator(std::make_shared<PerlinModulator>(idString, syncP, rateP, octavesP, widthP, noiseP, ranges, maxOctaves));
+		}
+		// SLOTS
+		/*
+		* reserves a modulator handle for each of numSlots slots, whose parameters start at firstParameter.
+		* empty slots are not in the processing order and their parameters aren't processed either
+		*/
+		void initSlots(const int firstParameter, const int numSlots, const int paramsPerSlot) {
+			const auto firstHandle = static_cast<int>(modulatorsByHandle.size());
+			slotPool = std::make_shared<SlotPool>(firstParameter, numSlots, paramsPerSlot, firstHandle);
+			slotTypes.assign(numSlots, -1);
+			modulatorsByHandle.resize(firstHandle + numSlots);
+			destinations.resize(firstHandle + numSlots, std::make_shared<const DestinationList>());
+			updateActiveParameters();
+		}
+		/* create builds a modulator on the slot's first ranges.size() parameters */
+		int addSlotType(const juce::String& name, std::vector<juce::NormalisableRange<float>>&& ranges, SlotPool::Create&& create) {
+			return slotPool->addType(name, std::move(ranges), std::move(create));
+		}
+		/*
+		* puts a modulator of type t into the slot. it's only created the first time the slot
+		* gets this type, after that the pooled one is reused without its old destinations
+		*/
+		std::shared_ptr<Modulator> setSlot(const int slot, const int t) {
+			if (slot < 0 || slot >= getNumSlots() || t < 0 || t >= slotPool->getNumTypes()) return nullptr;
+			if (slotTypes[slot] == t) return getSlotModulator(slot);
+			freeSlot(slot);
+			markModified();
+			const auto& slotType = slotPool->getType(t);
+			std::vector<std::shared_ptr<Parameter>> params;
+			for (auto p = 0; p < slotType.ranges.size(); ++p) {
+				auto param = getParameter(slotPool->getParameterHandle(slot, p));
+				param->setRange(&slotType.ranges[p]);
+				params.push_back(param);
+			}
+			auto& mod = slotPool->getModulator(slot, t);
+			if (mod == nullptr) {
+				mod = slotType.create(slotPool->getModulatorID(slot), params);
+				if (maxBlockSize != 0)
+					mod->prepareToPlay(preparedChannels, Fs);
+			}
+			mod->handle = slotPool->getModulatorHandle(slot);
+			destinations[mod->handle] = std::make_shared<const DestinationList>();
+			for (const auto& p : params)
+				parameterOwner[p->handle] = mod->handle;
+			if (maxBlockSize != 0 && mod->getNumOutputChannels(preparedChannels) > block.getNumChannels())
+				block.setSize(mod->getNumOutputChannels(preparedChannels), maxBlockSize, true, false, true);
+			modulators.push_back(mod);
+			modulatorsByHandle[mod->handle] = mod;
+			slotTypes[slot] = t;
+			updateActiveParameters();
+			return mod;
+		}
+		/*
+		* takes the slot's modulator out of the processing order. it stays in the pool.
+		* its parameters stop being processed, so nothing may modulate them anymore
+		*/
+		void freeSlot(const int slot) {
+			const auto mod = getSlotModulator(slot);
+			if (mod == nullptr) return;
+			markModified();
+			modulators.erase(std::find(modulators.begin(), modulators.end(), mod));
+			modulatorsByHandle[mod->handle] = nullptr;
+			for (const auto& m : modulators)
+				if (getDestinations(m->handle).modulates(*mod))
+					editDestinations(m->handle).removeDestinations(*mod);
+			for (const auto& p : mod->getParameters()) {
+				parameterOwner[p->handle] = -1;
+				p->setRange(nullptr);
+			}
+			if (selectedModulator == mod)
+				selectModulator(-1);
+			slotTypes[slot] = -1;
+			updateActiveParameters();
+		}
+		int getNumSlots() const noexcept { return static_cast<int>(slotTypes.size()); }
+		/* index of the slot's type, -1 if empty */
+		int getSlotType(const int slot) const noexcept {
+			return slot >= 0 && slot < getNumSlots() ? slotTypes[slot] : -1;
+		}
+		std::shared_ptr<Modulator> getSlotModulator(const int slot) noexcept {
+			return getSlotType(slot) == -1 ? nullptr : getModulator(slotPool->getModulatorHandle(slot));
 		}
+		const SlotPool* getSlotPool() const noexcept { return slotPool.get(); }
 		// MODIFY / REPLACE
-		void selectModulator(const juce::Identifier& mID) { selectedModulator = getModulator(mID); }
+		void selectModulator(const juce::Identifier& mID) { selectModulator(getModulatorHandle(mID)); }
+		/* every parameter shows how the selected modulator is routed to it, so all of them get flagged */
+		void selectModulator(const int mHandle) {
+			selectedModulator = getModulator(mHandle);
+			changes->setAll();
+		}
 		void addDestination(const juce::Identifier& mID, const juce::Identifier& dID, ChannelSetup channelSetup, const float atten = 1.f, const bool bidirec = false) {
-			auto param = getParameter(dID);
-			auto thisMod = getModulator(mID);
-			if (param != nullptr) { // destination belongs to a parameter
-				for (auto t = 0; t < modulators.size(); ++t) { // search for mod i wanna add a dest to
-					auto maybeThisMod = modulators[t];
-					if (maybeThisMod == thisMod)  // found it.
-						for (auto m = 0; m < modulators.size(); ++m) { // search for mod that has the parameter
-							auto otherMod = modulators[m];
-							if (otherMod->usesParameter(dID)) // found it
-								if (otherMod != thisMod) // does the parameter belong to another mod?
-								{
-									thisMod->addDestination(param, channelSetup, atten, bidirec); // add dest
-									if (t > m) // swap if needed
-										std::swap(modulators[t], modulators[m]);
-									if (otherMod->modulates(*thisMod)) // remove conflicting dests from other mod
-									{
-										otherMod->removeDestinations(thisMod.get());
-									}
-									return;
-								}
-								else return;
-						}
-				}
-				// destination's parameter doesn't belong to any modulator, so just add
-				thisMod->addDestination(param, channelSetup, atten, bidirec);
-				return;
-			}
+			addDestination(getModulatorHandle(mID), getParameterHandle(dID), channelSetup, atten, bidirec);
+		}
+		/*
+		* a modulator can't modulate its own parameters. if the parameter belongs to
+		* another modulator, this one has to run first and the other one can't modulate it back
+		*/
+		void addDestination(const int mHandle, const int pHandle, ChannelSetup channelSetup, const float atten = 1.f, const bool bidirec = false) {
+			auto param = getParameter(pHandle);
+			const auto thisMod = getModulator(mHandle);
+			if (param == nullptr || thisMod == nullptr || !isParameterActive(pHandle)) return;
+			const auto ownerHandle = parameterOwner[pHandle];
+			if (ownerHandle == mHandle) return;
+			markModified();
+			editDestinations(mHandle).addDestination(param, channelSetup, atten, bidirec);
+			if (ownerHandle == -1) return;
+			const auto otherMod = getModulator(ownerHandle);
+			const auto t = std::find(modulators.begin(), modulators.end(), thisMod);
+			const auto m = std::find(modulators.begin(), modulators.end(), otherMod);
+			if (t > m)
+				std::iter_swap(t, m);
+			if (getDestinations(ownerHandle).modulates(*thisMod))
+				editDestinations(ownerHandle).removeDestinations(*thisMod);
 		}
 		void addDestination(const juce::Identifier& mID, const juce::Identifier& dID, std::vector<float>& destBlock, ChannelSetup channelSetup, const float atten = 1.f, const bool bidirec = false) {
 				// destination is not a parameter, so add unchecked
-				auto thisMod = getModulator(mID);
-				thisMod->addDestination(dID, destBlock, channelSetup, atten, bidirec);
+				markModified();
+				editDestinations(getModulatorHandle(mID)).addDestination(dID, destBlock, channelSetup, atten, bidirec);
 				return;
 		}
 		void removeDestination(const juce::Identifier& mID, const juce::Identifier& dID) {
-			getModulator(mID)->removeDestination(dID);
+			markModified();
+			editDestinations(getModulatorHandle(mID)).removeDestination(dID);
+		}
+		void removeDestination(const int mHandle, const int pHandle) {
+			markModified();
+			editDestinations(mHandle).removeDestination(pHandle);
+		}
+		/* edit a routing in place, without copying the matrix */
+		void setAttenuvertor(const int mHandle, const int pHandle, const float value) {
+			if (const auto dest = getDestination(mHandle, pHandle)) {
+				dest->setValue(value);
+				markModified(mHandle, pHandle);
+			}
+		}
+		void setBidirectional(const int mHandle, const int pHandle, const bool b) {
+			if (const auto dest = getDestination(mHandle, pHandle)) {
+				dest->setBirectional(b);
+				markModified(mHandle, pHandle);
+			}
+		}
+		void setBias(const int mHandle, const int pHandle, const float b) {
+			if (const auto dest = getDestination(mHandle, pHandle)) {
+				dest->setBias(b);
+				markModified(mHandle, pHandle);
+			}
+		}
+		void setInputBus(const int mHandle, const int bus) {
+			if (const auto mod = getModulator(mHandle)) {
+				mod->setInputBus(bus);
+				markModified(mHandle, -1);
+			}
 		}
 		// PROCESS
 		void processBlock(const juce::AudioBuffer<float>& audioBuffer, juce::AudioPlayHead* playHead) {
-			const auto numChannels = audioBuffer.getNumChannels();
+			const AudioInput mainInput{ audioBuffer.getArrayOfReadPointers(), audioBuffer.getNumChannels() };
+			processBlock(audioBuffer, &mainInput, 1, playHead);
+		}
+		/*
+		* inputs[bus] are views onto the input buses, nothing gets copied. each modulator that
+		* accepts audio reads the bus it selected, or the main bus (inputs[0]) if that one is missing
+		*/
+		void processBlock(const juce::AudioBuffer<float>& audioBuffer, const AudioInput* inputs, const int numInputs, juce::AudioPlayHead* playHead) {
 			const auto numSamples = audioBuffer.getNumSamples();
 			if (playHead) playHead->getCurrentPosition(curPosInfo);
-			for (auto& p : parameters) p.get()->processBlock(numSamples);
+			for (const auto p : activeParameters) parameters[p]->processBlock(numSamples);
+			const auto applyGlobals = needsGlobalStage(numSamples);
+			if (applyGlobals) updateGlobalGains(numSamples);
 			auto modsBlock = block.getArrayOfWritePointers();
-			for (auto& m : modulators) {
-				m->processBlock(audioBuffer, modsBlock, curPosInfo);
-				m->processDestinations(modsBlock, numSamples);
-			}
+			for (auto& m : modulators)
+				processModulator(*m, audioBuffer, inputs, numInputs, modsBlock, applyGlobals);
 			const auto lastSample = numSamples - 1;
-			for (auto& parameter : parameters) {
-				auto p = parameter.get();
+			for (const auto pHandle : activeParameters) {
+				auto p = parameters[pHandle].get();
 				p->limit(numSamples);
 				p->storeSumValue(lastSample);
 			}
+			if (auto h = history->getActive())
+				h->push(parameters, activeParameters, numSamples);
+			publishSnapshot();
 		}
 		// GET
 		std::shared_ptr<Modulator> getSelectedModulator() noexcept { return selectedModulator; }
-		std::shared_ptr<Modulator> getModulator(const juce::Identifier& mID) noexcept {
-			for (auto& mod : modulators) {
-				auto m = mod.get();
-				if (m->hasID(mID))
-					return mod;
-			}
-			return nullptr;
-		}
-		std::shared_ptr<Parameter> getParameter(const juce::Identifier& pID) {
-			for (auto& parameter : parameters)
-				if (parameter.get()->hasID(pID))
-					return parameter;
-			return nullptr;
+		/* string lookups. resolve a handle once with these, then use the handle overloads */
+		int getModulatorHandle(const juce::Identifier& mID) const noexcept {
+			for (const auto& mod : modulatorsByHandle)
+				if (mod != nullptr && mod->hasID(mID))
+					return mod->handle;
+			return -1;
+		}
+		int getParameterHandle(const juce::Identifier& pID) const noexcept {
+			for (const auto& parameter : parameters)
+				if (parameter->hasID(pID))
+					return parameter->handle;
+			return -1;
+		}
+		std::shared_ptr<Modulator> getModulator(const juce::Identifier& mID) noexcept { return getModulator(getModulatorHandle(mID)); }
+		std::shared_ptr<Parameter> getParameter(const juce::Identifier& pID) { return getParameter(getParameterHandle(pID)); }
+		// GET BY HANDLE
+		std::shared_ptr<Modulator> getModulator(const int mHandle) noexcept {
+			return mHandle >= 0 && mHandle < modulatorsByHandle.size() ? modulatorsByHandle[mHandle] : nullptr;
+		}
+		/* this copy's destinations of the modulator */
+		const DestinationList& getDestinations(const int mHandle) const noexcept { return *destinations[mHandle]; }
+		std::shared_ptr<Destination> getDestination(const int mHandle, const int pHandle) const noexcept {
+			return mHandle >= 0 && mHandle < destinations.size() ? destinations[mHandle]->getDestination(pHandle) : nullptr;
+		}
+		/* handles go from 0 to this. free slots are nullptr */
+		int getNumModulatorHandles() const noexcept { return static_cast<int>(modulatorsByHandle.size()); }
+		std::shared_ptr<Parameter> getParameter(const int pHandle) noexcept {
+			return pHandle >= 0 && pHandle < parameters.size() ? parameters[pHandle] : nullptr;
+		}
+		/* displays (de)activate their modulator's ring in it, see ScopeTable */
+		const std::shared_ptr<ScopeTable>& getScopes() const noexcept { return scopes; }
+		/* history views open and close the parameter history in it, see ParameterHistoryGate */
+		const std::shared_ptr<ParameterHistoryGate>& getHistory() const noexcept { return history; }
+		/* the editor's view of the last processed block. only read it from one thread */
+		const UISnapshot& readSnapshot() noexcept { return snapshots->read(); }
+		/* what changed since the last call, see ChangeFlags. same thread as readSnapshot */
+		const ChangeFlags::Set& collectChanges() noexcept { return changes->collect(); }
+		/* for components that weren't there yet when their handles were flagged. -1 = none */
+		void flagChanged(const int mHandle, const int pHandle) noexcept {
+			changes->setModulator(mHandle);
+			changes->setParameter(pHandle);
 		}
 	protected:
-		std::vector<std::shared_ptr<Parameter>> parameters;
-		std::vector<std::shared_ptr<Modulator>> modulators;
+		std::vector<std::shared_ptr<Parameter>> parameters; // indexed by handle
+		std::vector<std::shared_ptr<Modulator>> modulators; // in processing order
+		std::vector<std::shared_ptr<Modulator>> modulatorsByHandle;
+		std::vector<std::shared_ptr<const DestinationList>> destinations; // by modulator handle, see editDestinations
+		std::vector<int> parameterOwner; // parameter handle -> handle of the modulator it belongs to, -1 if none
+		std::vector<int> activeParameters; // handles of the parameters that get processed, all but the unused slot ones
 		juce::AudioPlayHead::CurrentPositionInfo curPosInfo;
 		juce::AudioBuffer<float> block;
 		std::shared_ptr<Modulator> selectedModulator;
+		int maxBlockSize;
+		std::shared_ptr<SlotPool> slotPool;
+		std::vector<int> slotTypes; // slot -> index of its type in slotPool, -1 if empty
+		int preparedChannels;
+		double Fs;
+		std::shared_ptr<juce::Atomic<int>> generation; // shared by all copies
+		int revision; // not shared, see markModified
+		std::shared_ptr<TripleBuffer<UISnapshot>> snapshots; // shared by all copies, replaced in prepareToPlay
+		std::shared_ptr<ChangeFlags> changes; // same
+		std::shared_ptr<ScopeTable> scopes; // shared by all copies, replaced in prepareToPlay
+		std::shared_ptr<ParameterHistoryGate> history; // shared by all copies, replaced in prepareToPlay
+		int depthHandle, modulesMixHandle; // -1 = no global stage
+		std::vector<bool> isMacro; // by modulator handle, modules mix tells their modulation apart
+		std::shared_ptr<GlobalStageLanes> lanes; // shared by all copies, replaced in prepareToPlay
+
+		void processModulator(Modulator& m, const juce::AudioBuffer<float>& audioBuffer, const AudioInput* inputs, const int numInputs, float** modsBlock, const bool applyGlobals) noexcept {
+			const auto numSamples = audioBuffer.getNumSamples();
+			if (m.acceptsAudio()) {
+				const auto bus = m.getInputBus();
+				const auto hasBus = bus > 0 && bus < numInputs && inputs[bus].isValid();
+				m.setInput(inputs[hasBus ? bus : 0]);
+			}
+			m.processBlock(audioBuffer, modsBlock, curPosInfo);
+			if (auto scope = scopes->getActive(m.handle))
+				scope->push(modsBlock[scope->getChannel()], numSamples);
+			const auto& dests = *destinations[m.handle];
+			if (!applyGlobals) {
+				dests.processBlock(modsBlock, numSamples);
+				return;
+			}
+			if (m.handle < isMacro.size() && isMacro[m.handle])
+				dests.processBlock(modsBlock, numSamples, lanes->macros.data());
+			else
+				dests.processBlock(modsBlock, numSamples, lanes->modules.data());
+			// the modulators after this one see depth and modules mix with its modulation
+			if (dests.hasDestination(depthHandle) || dests.hasDestination(modulesMixHandle))
+				updateGlobalGains(numSamples);
+		}
+		/* skipped while depth is 1 and modules mix .5, both unmodulated and not smoothing */
+		bool needsGlobalStage(const int numSamples) const noexcept {
+			if (depthHandle == -1 || lanes->macros.empty()) return false;
+			return !isUnmodulatedAt(depthHandle, 1.f, numSamples) || !isUnmodulatedAt(modulesMixHandle, .5f, numSamples);
+		}
+		bool isUnmodulatedAt(const int pHandle, const float value, const int numSamples) const noexcept {
+			const auto& p = *parameters[pHandle];
+			if (!p.isConstant(numSamples) || p.get(0) != value) return false;
+			for (const auto& m : modulators)
+				if (destinations[m->handle]->hasDestination(pHandle)) return false;
+			return true;
+		}
+		/*
+		* out = base + macroGain * macroModulation + modulesGain * modulesModulation, with
+		* macroGain = depth * min(1, 2 - 2 * modulesMix) and modulesGain = depth * min(1, 2 * modulesMix).
+		* every destination scales its modulation as it adds it, so a modulator that reads its parameters
+		* sees them with the global stage applied, like every other modulation that came before it.
+		* runs before the first modulator and again after every modulator that modulates depth or modules mix
+		*/
+		void updateGlobalGains(const int numSamples) noexcept {
+			auto& gains = lanes->gains;
+			const auto macroGain = gains.getWritePointer(GlobalStageLanes::MacroGain);
+			const auto modulesGain = gains.getWritePointer(GlobalStageLanes::ModulesGain);
+			const auto depth = gains.getWritePointer(GlobalStageLanes::Scratch);
+			juce::FloatVectorOperations::clip(modulesGain, parameters[modulesMixHandle]->data().data(), 0.f, 1.f, numSamples);
+			juce::FloatVectorOperations::multiply(macroGain, modulesGain, -2.f, numSamples);
+			juce::FloatVectorOperations::add(macroGain, 2.f, numSamples);
+			juce::FloatVectorOperations::min(macroGain, macroGain, 1.f, numSamples);
+			juce::FloatVectorOperations::multiply(modulesGain, 2.f, numSamples);
+			juce::FloatVectorOperations::min(modulesGain, modulesGain, 1.f, numSamples);
+			juce::FloatVectorOperations::clip(depth, parameters[depthHandle]->data().data(), 0.f, 1.f, numSamples);
+			juce::FloatVectorOperations::multiply(macroGain, depth, numSamples);
+			juce::FloatVectorOperations::multiply(modulesGain, depth, numSamples);
+		}
+
+		/* O(parameters + modulators) per block, no allocation */
+		void publishSnapshot() noexcept {
+			auto& snapshot = snapshots->getWriteBuffer();
+			for (const auto p : activeParameters)
+				if (snapshot.hasParameter(p))
+					snapshot.sumValues[p] = parameters[p]->getSumValue();
+			for (const auto& m : modulators) {
+				const auto mHandle = m->handle;
+				if (!snapshot.hasModulator(mHandle)) continue;
+				const auto numOutValues = std::min(m->getNumOutValues(), static_cast<int>(UISnapshot::MaxOutValues));
+				for (auto ch = 0; ch < numOutValues; ++ch)
+					snapshot.outValues[mHandle * UISnapshot::MaxOutValues + ch] = m->getOutValue(ch);
+			}
+			changes->detect(snapshot);
+			snapshots->publish();
+		}
+		/* a slot's parameters are only processed while the slot's type uses them */
+		bool isParameterActive(const int pHandle) const noexcept {
+			const auto slot = slotPool != nullptr ? slotPool->getSlotOfParameter(pHandle) : -1;
+			if (slot == -1) return true;
+			const auto t = slotTypes[slot];
+			return t != -1 && slotPool->getIndexInSlot(pHandle) < slotPool->getType(t).ranges.size();
+		}
+		void updateActiveParameters() {
+			activeParameters.clear();
+			for (auto p = 0; p < parameters.size(); ++p)
+				if (isParameterActive(p))
+					activeParameters.push_back(p);
+		}
+		/* removes the parameter destinations that aren't wanted[handle] or have another channel setup */
+		void removeUnwantedDestinations(const int mHandle, const std::vector<const RoutingState::Dest*>& wanted) {
+			std::vector<int> unwanted;
+			for (const auto& d : getDestinations(mHandle)) {
+				if (d->handle == -1) continue;
+				const auto w = d->handle < wanted.size() ? wanted[d->handle] : nullptr;
+				if (w == nullptr || w->channelSetup != d->getChannelSetup())
+					unwanted.push_back(d->handle);
+			}
+			if (unwanted.empty()) return;
+			auto& dests = editDestinations(mHandle);
+			for (const auto pHandle : unwanted)
+				dests.removeDestination(pHandle);
+			markModified();
+		}
+		/*
+		* the modulator's destinations, to be edited. the audio thread might process the list
+		* this copy shares with another one, so it gets replaced by a copy first
+		*/
+		DestinationList& editDestinations(const int mHandle) {
+			const auto edited = std::make_shared<DestinationList>(*destinations[mHandle]);
+			destinations[mHandle] = edited;
+			return *edited;
+		}
+		void addParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& pID) {
+			const auto pHandle = static_cast<int>(parameters.size());
+			parameters.push_back(std::make_shared<Parameter>(apvts, pID, pHandle));
+		}
+		std::shared_ptr<Modulator> addModulator(std::shared_ptr<Modulator>&& mod) {
+			mod->handle = static_cast<int>(modulatorsByHandle.size());
+			for (const auto& p : mod->getParameters())
+				if (p != nullptr)
+					parameterOwner[p->handle] = mod->handle;
+			modulators.push_back(mod);
+			modulatorsByHandle.push_back(mod);
+			destinations.push_back(std::make_shared<const DestinationList>());
+			isMacro.resize(modulatorsByHandle.size());
+			isMacro[mod->handle] = juce::String(mod->getTypeName()) == "Macro";
+			return mod;
+		}
 	};
 
 	/* to do:
 	*
-	* destination: bias / weight
-	*
 	* rewrite parameter so has functions to give back min and max of range
 	*	then implement maxOctaves in processBlock of perlinMod to get from there
 	* 
 	* envelopeFollowerModulator
 	*	rewrite db to gain calculation so that it happens before parameter smoothing instead
-	*	add lookahead parameter
 	*
 	* lfoModulator
 	*	add pump curve wavetable
@@ -1215,9 +3185,5 @@ namespace modSys2 {
 	* all wavy mods (especially temposync ones)
 	*	phase parameter
 	*
-	* editor
-	*	find more elegant way for vectorizing all modulatable parameters
-	*	rather than making a ton of huge ass initializer lists, lol
-	*
 	*/
 }
\ No newline at end of file
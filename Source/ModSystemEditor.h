@@ -26,7 +26,7 @@ namespace modSys2Editor {
 			void paint(juce::Graphics& g) override {
 				g.setColour(juce::Colours::limegreen);
 				auto matrix = processor.matrix.getUpdatedPtr();
-				const auto dest = matrix->getSelectedModulator()->getDestination(parameter.id);
+				const auto dest = matrix->getDestination(matrix->getSelectedModulator()->handle, parameter.handle);
 				if (dest == nullptr) return;
 				const juce::String txt = dest->isBidirectional() ? "Mb" : "M";
 				g.drawFittedText(txt, getLocalBounds(), juce::Justification::centred, 1);
@@ -35,7 +35,7 @@ namespace modSys2Editor {
 			void mouseDown(const juce::MouseEvent&) override {
 				auto matrix = processor.matrix.getUpdatedPtr();
 				const auto slcm = matrix->getSelectedModulator();
-				auto atten = slcm->getAttenuvertor(parameter.id);
+				auto atten = matrix->getDestination(slcm->handle, parameter.handle)->getValue();
 				dragStartValue = atten;
 			}
 			void mouseDrag(const juce::MouseEvent& evt) override {
@@ -45,19 +45,21 @@ namespace modSys2Editor {
 				const auto speed = evt.mods.isShiftDown() ? .01f : .1f;
 				const auto value = juce::jlimit(-1.f, 1.f, dragStartValue + v * speed);
 				auto s = matrix->getSelectedModulator();
-				s->setAttenuvertor(matrix->getParameter(parameter.id)->id, value);
+				matrix->setAttenuvertor(s->handle, parameter.handle, value);
 			}
 			void mouseUp(const juce::MouseEvent& evt) override {
 				if (evt.mouseWasDraggedSinceMouseDown()) return;
 				else if (evt.mods.isRightButtonDown()) {
 					auto matrix = processor.matrix.getCopyOfUpdatedPtr();
 					const auto m = matrix->getSelectedModulator();
-					matrix->removeDestination(m->id, parameter.id);
+					matrix->removeDestination(m->handle, parameter.handle);
 					processor.matrix.replaceUpdatedPtrWith(matrix);
 				}
 				else {
-					auto dest = processor.matrix->getSelectedModulator()->getDestination(parameter.id);
-					dest->setBirectional(!dest->isBidirectional());
+					const auto matrix = processor.matrix.getUpdatedPtr();
+					const auto m = matrix->getSelectedModulator();
+					const auto dest = matrix->getDestination(m->handle, parameter.handle);
+					matrix->setBidirectional(m->handle, parameter.handle, !dest->isBidirectional());
 				}
 			}
 
@@ -66,38 +68,33 @@ namespace modSys2Editor {
 	public:
 		Parameter(ModularTestAudioProcessor& p, const juce::String& pID, const int numChannels, const juce::String& linkedModID = "") :
 			processor(p),
-			modSys2::Identifiable(pID),
+			modSys2::Identifiable(pID, p.matrix->getParameterHandle(pID)),
 			parameter(*p.apvts.getParameter(id)),
-			attach(parameter, [this](float) { repaint(); }, nullptr),
+			attach(parameter, [this](float) { parameterChanged(); }, nullptr),
 			linkedModulatorID(),
 			modGainDragger(p, *this),
-			sumValue(0), curModSumValue(0)
+			sumValue(0), attenuvertor(0)
 		{
 			if(linkedModID.isNotEmpty()) linkedModulatorID = linkedModID;
 			addChildComponent(modGainDragger);
 			attach.sendInitialUpdate();
 		}
-		void timerCallback(const std::shared_ptr<modSys2::Matrix>& matrix) {
-			const auto value = parameter.getValue();
-			const auto selectedMod = matrix.get()->getSelectedModulator();
-			auto cmsv = value;
-			if (selectedMod != nullptr) {
-				auto sm = selectedMod;
-				if (sm->hasDestination(id)) {
-					modGainDragger.setVisible(true);
-					const auto atten = sm->getAttenuvertor(id);
-					cmsv += atten;
-				}
-				else modGainDragger.setVisible(false);
-			}
-			bool needRepaint = false;
-			const auto sv = matrix->getParameter(id)->getSumValue();
-			if (curModSumValue != cmsv || sumValue != sv) {
-				curModSumValue = cmsv;
+		/* only does something if the matrix flagged this parameter. the routing is taken from the matrix, the sum from the snapshot */
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			if (!changed.hasParameter(handle)) return;
+			const auto selected = matrix.getSelectedModulator();
+			const auto dest = selected != nullptr ? matrix.getDestination(selected->handle, handle) : nullptr;
+			modGainDragger.setVisible(dest != nullptr);
+			if (dest != nullptr) modGainDragger.repaint();
+			const auto atten = dest != nullptr ? dest->getValue() : 0.f;
+			const auto sv = snapshot.getSumValue(handle);
+			if (attenuvertor != atten || sumValue != sv) {
+				const auto prevSumValue = sumValue;
+				const auto prevAttenuvertor = attenuvertor;
+				attenuvertor = atten;
 				sumValue = sv;
-				needRepaint = true;
+				modulationChanged(prevSumValue, prevAttenuvertor);
 			}
-			if(needRepaint) repaint();
 		}
 	protected:
 		ModularTestAudioProcessor& processor;
@@ -105,7 +102,12 @@ namespace modSys2Editor {
 		juce::ParameterAttachment attach;
 		juce::Identifier linkedModulatorID;
 		SelectedModulatorGainDragger modGainDragger;
-		float sumValue, curModSumValue;
+		float sumValue, attenuvertor; // of the selected modulator
+
+		/* the parameter's own value changed */
+		virtual void parameterChanged() { repaint(); }
+		/* sumValue or attenuvertor changed, the previous ones are passed in */
+		virtual void modulationChanged(const float, const float) { repaint(); }
 
 		void mouseDown(const juce::MouseEvent&) override { selectLinkedModulator(); }
 
@@ -127,23 +129,57 @@ namespace modSys2Editor {
 	{
 		ParameterExample(ModularTestAudioProcessor& p, const juce::String& pID, const int numChannels, const juce::String& linkedModID = "") :
 			Parameter(p, pID, numChannels, linkedModID),
-			dragStartValue(0)
+			dragStartValue(0),
+			staticLayer(),
+			valueText(parameter.getCurrentValueAsText()),
+			sumText("sum: 0")
 		{ }
 	protected:
 		float dragStartValue;
+		juce::Image staticLayer; // frame and name, only redrawn in resized
+		juce::String valueText, sumText; // only formatted when they change
+
+		void parameterChanged() override {
+			valueText = parameter.getCurrentValueAsText();
+			repaint();
+		}
+		/* only the columns the markers left and entered, and the sum text if it reads differently */
+		void modulationChanged(const float prevSumValue, const float prevAttenuvertor) override {
+			const auto value = parameter.getValue();
+			auto dirty = getMarkerArea(value, prevSumValue, prevAttenuvertor).getUnion(getMarkerArea(value, sumValue, attenuvertor));
+			const auto txt = "sum: " + juce::String(sumValue).substring(0, 4);
+			if (sumText != txt) {
+				sumText = txt;
+				dirty = dirty.getUnion(getRow(2));
+			}
+			repaint(dirty);
+		}
+		juce::Rectangle<int> getMarkerArea(const float value, const float sv, const float atten) const {
+			const auto width = static_cast<float>(getWidth());
+			const auto x0 = value * width;
+			const auto x1 = (value + atten) * width;
+			const auto x2 = sv * width;
+			const auto left = static_cast<int>(std::min({ x0, x1, x2 })) - 2;
+			const auto right = static_cast<int>(std::max({ x0, x1, x2 })) + 3;
+			return { left, 0, right - left, getHeight() };
+		}
+		/* name, value and sum each get a third of the height */
+		juce::Rectangle<int> getRow(const int row) const {
+			const auto rowHeight = getHeight() / 3;
+			return { 0, row * rowHeight, getWidth(), rowHeight };
+		}
 
 		void paint(juce::Graphics& g) override {
 			const auto width = static_cast<float>(getWidth());
 			const auto height = static_cast<float>(getHeight());
 			g.setColour(juce::Colours::darkslateblue);
-			g.drawRect(0.f, 0.f, width, height);
 
 			const auto value = parameter.getValue();
 			const auto x = value * width;
 			juce::Rectangle<float> valueArea(0.f, 0.f, x, height);
 			g.fillRect(valueArea);
 			
-			const auto sumX = static_cast<int>(curModSumValue * width);
+			const auto sumX = static_cast<int>((value + attenuvertor) * width);
 			auto startX = x;
 			auto rangeX = sumX - x;
 			if (rangeX < 0) {
@@ -169,12 +205,20 @@ namespace modSys2Editor {
 			g.drawVerticalLine(sumValueX, 0.f, height);
 			g.drawVerticalLine(sumValueX + 1, 0.f, height);
 
-			const auto actualValue = parameter.getCurrentValueAsText();
-			const auto valueStr = parameter.getName(64) + ":\n" + actualValue + "\nsum: " + juce::String(sumValue).substring(0, 4);
 			g.setColour(juce::Colours::white);
-			g.drawFittedText(valueStr, getLocalBounds(), juce::Justification::centredTop, 2);
+			g.drawFittedText(valueText, getRow(1), juce::Justification::centred, 1);
+			g.drawFittedText(sumText, getRow(2), juce::Justification::centred, 1);
+			g.drawImageAt(staticLayer, 0, 0);
+		}
+		void resized() override {
+			modGainDragger.setBounds(0, 0, getWidth() / 6, getHeight() / 6);
+			staticLayer = juce::Image(juce::Image::ARGB, std::max(1, getWidth()), std::max(1, getHeight()), true);
+			juce::Graphics g{ staticLayer };
+			g.setColour(juce::Colours::darkslateblue);
+			g.drawRect(0.f, 0.f, static_cast<float>(getWidth()), static_cast<float>(getHeight()));
+			g.setColour(juce::Colours::white);
+			g.drawFittedText(parameter.getName(64) + ":", getRow(0), juce::Justification::centred, 1);
 		}
-		void resized() override { modGainDragger.setBounds(0, 0, getWidth() / 6, getHeight() / 6); }
 		void mouseDown(const juce::MouseEvent& evt) override {
 			Parameter::mouseDown(evt);
 			dragStartValue = parameter.getValue();
@@ -205,6 +249,95 @@ namespace modSys2Editor {
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterExample)
 	};
 
+	/*
+	* uniform grid over the modulatable parameters, so a drag only tests the few parameters
+	* in the cells under the dragger. works in the coordinates of root, so targets can live in
+	* different components. rebuild it whenever the targets were moved, created or deleted
+	*/
+	struct TargetGrid {
+		using Collect = std::function<void(std::vector<Parameter*>&)>;
+
+		/* collect fills in the current targets, in the order hits should prefer them */
+		TargetGrid(juce::Component& rootComponent, const Collect& collectTargets) :
+			root(rootComponent),
+			collect(collectTargets),
+			targets(),
+			targetBounds(),
+			cells(),
+			area(),
+			cellSize(1),
+			numCols(0),
+			numRows(0)
+		{}
+		juce::Component& getRoot() noexcept { return root; }
+		/* buckets every showing target into the cells it overlaps. a cell is about as big as an average target */
+		void rebuild() {
+			collect(targets);
+			targets.erase(std::remove_if(targets.begin(), targets.end(), [](const Parameter* t) { return !t->isShowing(); }), targets.end());
+			cells.clear();
+			targetBounds.clear();
+			numCols = numRows = 0;
+			if (targets.empty()) return;
+			auto sizeSum = 0;
+			for (const auto& t : targets) {
+				targetBounds.push_back(root.getLocalArea(t, t->getLocalBounds()));
+				sizeSum += std::max(t->getWidth(), t->getHeight());
+			}
+			area = targetBounds.front();
+			for (const auto& b : targetBounds)
+				area = area.getUnion(b);
+			cellSize = std::max(1, sizeSum / static_cast<int>(targets.size()));
+			numCols = area.getWidth() / cellSize + 1;
+			numRows = area.getHeight() / cellSize + 1;
+			cells.resize(static_cast<size_t>(numCols * numRows));
+			for (auto i = 0; i < targets.size(); ++i) {
+				const auto& b = targetBounds[i];
+				for (auto row = getRow(b.getY()); row <= getRow(b.getBottom()); ++row)
+					for (auto col = getCol(b.getX()); col <= getCol(b.getRight()); ++col)
+						cells[row * numCols + col].push_back(i);
+			}
+		}
+		/* the first target, in the order of collect, that overlaps c */
+		Parameter* getFirstHit(const juce::Component& c) const {
+			auto first = static_cast<int>(targets.size());
+			forEachCandidate(getBoundsInRoot(c), [&](const int i) { first = std::min(first, i); });
+			return first < targets.size() ? targets[first] : nullptr;
+		}
+		/* every target that overlaps c, each once, in no particular order */
+		void getHits(const juce::Component& c, std::vector<Parameter*>& hits) const {
+			hits.clear();
+			forEachCandidate(getBoundsInRoot(c), [&](const int i) { hits.push_back(targets[i]); });
+		}
+	protected:
+		juce::Component& root;
+		Collect collect;
+		std::vector<Parameter*> targets;
+		std::vector<juce::Rectangle<int>> targetBounds; // in root
+		std::vector<std::vector<int>> cells; // indexes into targets
+		juce::Rectangle<int> area;
+		int cellSize, numCols, numRows;
+
+		int getCol(const int x) const noexcept { return juce::jlimit(0, numCols - 1, (x - area.getX()) / cellSize); }
+		int getRow(const int y) const noexcept { return juce::jlimit(0, numRows - 1, (y - area.getY()) / cellSize); }
+		juce::Rectangle<int> getBoundsInRoot(const juce::Component& c) const {
+			return root.getLocalArea(c.getParentComponent(), c.getBounds());
+		}
+
+		/* calls onHit for targets overlapping bounds. a target spanning several cells only counts in the
+		cell of the top left corner of its overlap, so nothing is reported twice */
+		template<typename OnHit>
+		void forEachCandidate(const juce::Rectangle<int>& bounds, OnHit&& onHit) const {
+			if (cells.empty()) return;
+			for (auto row = getRow(bounds.getY()); row <= getRow(bounds.getBottom()); ++row)
+				for (auto col = getCol(bounds.getX()); col <= getCol(bounds.getRight()); ++col)
+					for (const auto i : cells[row * numCols + col]) {
+						const auto overlap = bounds.getIntersection(targetBounds[i]);
+						if (!overlap.isEmpty() && getRow(overlap.getY()) == row && getCol(overlap.getX()) == col)
+							onHit(i);
+					}
+		}
+	};
+
 	/*
 	* component used to select a modulator and/or drag it to a destination
 	*/
@@ -212,21 +345,26 @@ namespace modSys2Editor {
 		public juce::Component,
 		public modSys2::Identifiable
 	{
-		ModulatorDragger(ModularTestAudioProcessor& p, const juce::String& mID, std::vector<Parameter*>& modulatables) :
-			Identifiable(mID),
+		ModulatorDragger(ModularTestAudioProcessor& p, const juce::String& mID, TargetGrid& targets,
+			const modSys2::ChannelSetup chSetup = modSys2::ChannelSetup::Left) :
+			Identifiable(mID, p.matrix->getModulatorHandle(mID)),
 			processor(p),
 			draggerfall(),
 			bounds(),
-			modulatableParameters(modulatables),
+			targetGrid(targets),
+			home(),
 			hoveredParameter(nullptr),
+			channelSetup(chSetup),
 			selected(false)
 		{}
 		void setQBounds(juce::Rectangle<int> b) {
 			bounds = b;
 			setBounds(bounds);
 		}
-		void timerCallback(const std::shared_ptr<modSys2::Matrix>& matrix) {
-			auto s = matrix.get()->getModulator(id) == matrix.get()->getSelectedModulator();
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			if (!changed.hasModulator(handle)) return;
+			const auto selectedMod = matrix.getSelectedModulator();
+			const auto s = selectedMod != nullptr && selectedMod->handle == handle;
 			if (selected != s) {
 				selected = s;
 				repaint();
@@ -236,14 +374,25 @@ namespace modSys2Editor {
 		ModularTestAudioProcessor& processor;
 		juce::ComponentDragger draggerfall;
 		juce::Rectangle<int> bounds;
-		std::vector<Parameter*>& modulatableParameters;
+		TargetGrid& targetGrid;
+		juce::Component::SafePointer<juce::Component> home; // the parent while the dragger is lifted into the root
 		Parameter* hoveredParameter;
+		const modSys2::ChannelSetup channelSetup;
 		bool selected;
 
+		/* lifts the dragger into the grid's root, so it isn't clipped by its own parent while dragging */
 		void mouseDown(const juce::MouseEvent& evt) override {
 			const auto matrix = processor.matrix.getUpdatedPtr();
-			matrix.get()->selectModulator(id);
+			matrix.get()->selectModulator(handle);
 			selected = true;
+			auto& root = targetGrid.getRoot();
+			if (getParentComponent() != &root) {
+				home = getParentComponent();
+				const auto b = root.getLocalArea(home, getBounds());
+				root.addAndMakeVisible(this);
+				setBounds(b);
+			}
+			targetGrid.rebuild();
 			draggerfall.startDraggingComponent(this, evt);
 		}
 		void mouseDrag(const juce::MouseEvent& evt) override {
@@ -253,14 +402,17 @@ namespace modSys2Editor {
 		void mouseUp(const juce::MouseEvent&) override {
 			if (hoveredParameter != nullptr) {
 				auto matrix = processor.matrix.getCopyOfUpdatedPtr();
-				const auto m = matrix->getModulator(id);
-				const auto p = matrix->getParameter(hoveredParameter->id);
+				const auto p = matrix->getParameter(hoveredParameter->handle);
 				const auto pValue = processor.apvts.getRawParameterValue(p->id);
 				const auto atten = 1.f - *pValue;
-				matrix->addDestination(m->id, p->id, modSys2::ChannelSetup::Left, atten, false);
+				matrix->addDestination(handle, p->handle, channelSetup, atten, false);
 				processor.matrix.replaceUpdatedPtrWith(matrix);
 				hoveredParameter = nullptr;
 			}
+			if (home != nullptr) {
+				home->addAndMakeVisible(this);
+				home = nullptr;
+			}
 			setBounds(bounds);
 			repaint();
 		}
@@ -283,16 +435,114 @@ namespace modSys2Editor {
 			g.drawArrow(juce::Line<float>(centre, { tBounds.getRight(), centre.y }), 2, arrowHead, arrowHead);
 		}
 
-		Parameter* getHoveredParameter() const {
-			for (const auto& p: modulatableParameters)
-				if (!getBounds().getIntersection(p->getBounds()).isEmpty())
-					return p;
-			return nullptr;
-		}
+		Parameter* getHoveredParameter() const { return targetGrid.getFirstHit(*this); }
 
 		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulatorDragger)
 	};
 
+	/*
+	* toggles whether a modulator listens to the sidechain or the main input
+	*/
+	struct InputBusButton :
+		public juce::ToggleButton,
+		public modSys2::Identifiable
+	{
+		InputBusButton(ModularTestAudioProcessor& p, const juce::String& mID) :
+			juce::ToggleButton("sc"),
+			Identifiable(mID, p.matrix->getModulatorHandle(mID)),
+			processor(p)
+		{
+			onClick = [this]() {
+				auto matrix = processor.matrix.getCopyOfUpdatedPtr();
+				matrix->setInputBus(handle, getToggleState() ? 1 : 0);
+				processor.matrix.replaceUpdatedPtrWith(matrix);
+			};
+		}
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			if (!changed.hasModulator(handle)) return;
+			const auto mod = matrix.getModulator(handle);
+			const auto sidechained = mod != nullptr && mod->getInputBus() != 0;
+			if (getToggleState() != sidechained)
+				setToggleState(sidechained, juce::dontSendNotification);
+		}
+	protected:
+		ModularTestAudioProcessor& processor;
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InputBusButton)
+	};
+
+	/*
+	* waveform history of one output channel of a modulator, one min/max pair per pixel column.
+	* scrolls from right to left, the newest frame at the right edge. history is a ring,
+	* so column x of it is shown at (x - getCursor()) mod getNumColumns().
+	* the matrix only feeds a ring buffer for it while the owning display is showing
+	*/
+	struct Scope {
+		static constexpr float Seconds = 2.f; // history that fits into the display
+
+		Scope(ModularTestAudioProcessor& p, const int mHandle, const int ch) :
+			processor(p),
+			handle(mHandle),
+			channel(ch),
+			table(),
+			ring(nullptr),
+			history(),
+			pulled(),
+			writeIdx(0)
+		{}
+		~Scope() { setActive(false, 0); }
+		/* only touches the matrix' scope table, never the matrix */
+		void setActive(const bool active, const int numColumns) {
+			const auto isActive = !history.empty();
+			if (active == isActive && (!active || history.size() == numColumns)) return;
+			history.assign(active ? std::max(0, std::min(numColumns, modSys2::ScopeRing::NumFrames / 2)) : 0, { 0.f, 0.f });
+			pulled.resize(history.size());
+			writeIdx = 0;
+			if (history.empty()) {
+				if (ring != nullptr) table->deactivate(handle);
+				table = nullptr;
+				ring = nullptr;
+			}
+			else activate(processor.matrix.getUpdatedPtr()->getScopes());
+		}
+		/* returns how many columns were written. they are the ones right before getCursor() */
+		int update(const modSys2::Matrix& matrix) {
+			if (history.empty()) return 0;
+			// prepareToPlay replaced the table for the new sample rate
+			if (matrix.getScopes() != table) activate(matrix.getScopes());
+			if (ring == nullptr) return 0;
+			const auto numFrames = ring->pull(pulled.data(), static_cast<int>(pulled.size()));
+			for (auto f = 0; f < numFrames; ++f) {
+				history[writeIdx] = pulled[f];
+				writeIdx = (writeIdx + 1) % history.size();
+			}
+			return numFrames;
+		}
+		int getCursor() const noexcept { return static_cast<int>(writeIdx); }
+		int getNumColumns() const noexcept { return static_cast<int>(history.size()); }
+		void paint(juce::Graphics& g, const float height) const {
+			for (auto x = 0; x < history.size(); ++x)
+				paintColumn(g, x, (writeIdx + x) % history.size(), height);
+		}
+		/* draws column idx of the history at x */
+		void paintColumn(juce::Graphics& g, const int x, const size_t idx, const float height) const {
+			const auto& frame = history[idx];
+			g.drawVerticalLine(x, height - frame.max * height, height - frame.min * height + 1.f);
+		}
+	protected:
+		ModularTestAudioProcessor& processor;
+		const int handle, channel;
+		std::shared_ptr<modSys2::ScopeTable> table; // keeps ring alive
+		modSys2::ScopeRing* ring;
+		std::vector<modSys2::ScopeRing::Frame> history, pulled;
+		size_t writeIdx;
+
+		void activate(const std::shared_ptr<modSys2::ScopeTable>& scopes) {
+			table = scopes;
+			ring = table->activate(handle, channel, history.size() / Seconds);
+		}
+	};
+
 	/*
 	* displays envelope follower data
 	*/
@@ -300,29 +550,42 @@ namespace modSys2Editor {
 		public juce::Component,
 		public modSys2::Identifiable
 	{
-		EnvelopeFollowerDisplay(int envFolIdx, const int numChannels) :
+		EnvelopeFollowerDisplay(ModularTestAudioProcessor& p, int envFolIdx, const int numChannels) :
+			EnvelopeFollowerDisplay(p, juce::String("EnvFol" + juce::String(envFolIdx)), numChannels, 0)
+		{}
+		/* shows numValues out values starting at firstChannel, f.ex. the bands of a multiband env fol */
+		EnvelopeFollowerDisplay(ModularTestAudioProcessor& p, const juce::String& mID, const int numValues, const int firstChannel) :
 			juce::Component(),
-			modSys2::Identifiable(juce::String("EnvFol" + juce::String(envFolIdx))),
-			curValue()
-		{ curValue.resize(numChannels, 0.f); }
-		void timerCallback(const std::shared_ptr<modSys2::Matrix>& matrix) {
-			bool needRepaint = false;
-			const auto mod = matrix->getModulator(id);
-			for (auto ch = 0; ch < curValue.size(); ++ch) {
-				const auto newValue = mod->getOutValue(ch);
-				if (curValue[ch] != newValue) {
-					curValue[ch] = newValue;
-					needRepaint = true;
+			modSys2::Identifiable(mID, p.matrix->getModulatorHandle(mID)),
+			curValue(),
+			channelOffset(firstChannel),
+			scope(p, handle, firstChannel)
+		{ curValue.resize(numValues, 0.f); }
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			bool needRepaint = scope.update(matrix) != 0;
+			if (changed.hasModulator(handle))
+				for (auto ch = 0; ch < curValue.size(); ++ch) {
+					const auto newValue = snapshot.getOutValue(handle, channelOffset + ch);
+					if (curValue[ch] != newValue) {
+						curValue[ch] = newValue;
+						needRepaint = true;
+					}
 				}
-			}
 			if(needRepaint) repaint();
 		}
 	protected:
 		std::vector<float> curValue;
-		
+		const int channelOffset;
+		Scope scope;
+
+		void resized() override { scope.setActive(isShowing(), getWidth()); }
+		void visibilityChanged() override { scope.setActive(isShowing(), getWidth()); }
+		void parentHierarchyChanged() override { scope.setActive(isShowing(), getWidth()); }
 		void paint(juce::Graphics& g) override {
 			const auto height = static_cast<float>(getHeight());
 			const auto width = static_cast<float>(getWidth());
+			g.setColour(juce::Colours::darkslateblue);
+			scope.paint(g, height);
 			g.setColour(juce::Colours::rebeccapurple);
 			g.drawRect(getLocalBounds());
 			for (auto ch = 0; ch < curValue.size(); ++ch) {
@@ -342,44 +605,443 @@ namespace modSys2Editor {
 		public juce::Component,
 		public modSys2::Identifiable
 	{
-		LFODisplay(const juce::String& mID, const int numChannels) :
+		static constexpr int FadeSteps = 8; // until a trail is gone
+
+		LFODisplay(ModularTestAudioProcessor& p, const juce::String& mID, const int numChannels) :
 			juce::Component(),
-			modSys2::Identifiable(mID),
-			img(juce::Image::RGB, 1, 1, true),
-			curValue()
+			modSys2::Identifiable(mID, p.matrix->getModulatorHandle(mID)),
+			trail(juce::Image::RGB, 1, 1, true),
+			scopeImg(juce::Image::ARGB, 1, 1, true),
+			fades(),
+			curValue(),
+			scope(p, handle, 0)
 		{ curValue.resize(numChannels, 0.f); }
-		void timerCallback(const std::shared_ptr<modSys2::Matrix>& matrix) {
-			bool needRepaint = false;
-			for (auto ch = 0; ch < curValue.size(); ++ch) {
-				const auto mod = matrix->getModulator(id);
-				auto newValue = mod->getOutValue(ch);
-				if (curValue[ch] != newValue) {
+		/*
+		* new scope frames are drawn into scopeImg in history order, scrolling is done when it's drawn.
+		* the trail only fades and repaints the columns the points passed in the last FadeSteps ticks
+		*/
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			const auto numNew = scope.update(matrix);
+			if (numNew != 0) {
+				const auto numColumns = scope.getNumColumns();
+				const auto height = static_cast<float>(scopeImg.getHeight());
+				juce::Graphics g0{ scopeImg };
+				g0.setColour(juce::Colours::darkslateblue);
+				for (auto i = 0; i < numNew; ++i) {
+					const auto idx = (scope.getCursor() - numNew + i + numColumns) % numColumns;
+					scopeImg.clear({ idx, 0, 1, scopeImg.getHeight() });
+					scope.paintColumn(g0, idx, idx, height);
+				}
+				repaint();
+			}
+			fadeTrail(numNew == 0);
+			if (changed.hasModulator(handle)) {
+				juce::Graphics g0{ trail };
+				g0.setColour(juce::Colours::rebeccapurple);
+				for (auto ch = 0; ch < curValue.size(); ++ch) {
+					const auto newValue = snapshot.getOutValue(handle, ch);
+					if (curValue[ch] == newValue) continue;
 					curValue[ch] = newValue;
-					needRepaint = true;
+					const auto area = getPointArea(newValue).getIntersection(trail.getBounds());
+					g0.fillEllipse(getPointBounds(newValue));
+					for (auto x = area.getX(); x < area.getRight(); ++x)
+						fades[x] = FadeSteps;
+					if (numNew == 0) repaint(area);
 				}
 			}
-			if (needRepaint) repaint();
 		}
 	protected:
-		juce::Image img;
+		juce::Image trail; // the points of the last FadeSteps ticks
+		juce::Image scopeImg; // one column per frame of the scope's history
+		std::vector<int> fades; // by column of trail, how often it gets faded still
 		std::vector<float> curValue;
-		void resized() override { img = img.rescaled(getWidth(), getHeight(), juce::Graphics::lowResamplingQuality).createCopy(); }
+		Scope scope;
+
+		juce::Rectangle<float> getPointBounds(const float value) const {
+			const auto x = value * static_cast<float>(getWidth());
+			const auto y = static_cast<float>(getHeight()) - value * static_cast<float>(getHeight());
+			return { x - 1, y - 1, 3, 3 };
+		}
+		juce::Rectangle<int> getPointArea(const float value) const {
+			const auto x = static_cast<int>(value * getWidth());
+			const auto y = static_cast<int>(getHeight() - value * getHeight());
+			return { x - 2, y - 2, 5, 5 };
+		}
+		/* fades runs of columns that still hold a trail at once */
+		void fadeTrail(const bool repaintFaded) {
+			juce::Graphics g0{ trail };
+			g0.setColour(juce::Colour(0x77000000));
+			const auto numColumns = static_cast<int>(fades.size());
+			for (auto x = 0; x < numColumns;) {
+				if (fades[x] == 0) { ++x; continue; }
+				const auto start = x;
+				for (; x < numColumns && fades[x] != 0; ++x)
+					--fades[x];
+				const juce::Rectangle<int> run(start, 0, x - start, trail.getHeight());
+				g0.fillRect(run);
+				if (repaintFaded) repaint(run);
+			}
+		}
+		/* (de)activates the scope and redraws all of its columns */
+		void updateScope() {
+			scope.setActive(isShowing(), getWidth());
+			scopeImg.clear(scopeImg.getBounds());
+			juce::Graphics g0{ scopeImg };
+			g0.setColour(juce::Colours::darkslateblue);
+			const auto height = static_cast<float>(scopeImg.getHeight());
+			for (auto idx = 0; idx < scope.getNumColumns(); ++idx)
+				scope.paintColumn(g0, idx, idx, height);
+		}
+		void resized() override {
+			const auto width = std::max(1, getWidth());
+			const auto height = std::max(1, getHeight());
+			trail = juce::Image(juce::Image::RGB, width, height, true);
+			scopeImg = juce::Image(juce::Image::ARGB, width, height, true);
+			fades.assign(static_cast<size_t>(width), 0);
+			updateScope();
+		}
+		void visibilityChanged() override { updateScope(); }
+		void parentHierarchyChanged() override { updateScope(); }
 
 		void paint(juce::Graphics& g) override {
-			juce::Graphics g0{ img };
-			const auto width = static_cast<float>(getWidth());
+			g.drawImageAt(trail, 0, 0, false);
+			// the oldest frame is at the cursor, so the part of the image from there goes left
+			const auto numColumns = scope.getNumColumns();
+			const auto cursor = scope.getCursor();
+			const auto height = scopeImg.getHeight();
+			g.drawImage(scopeImg, 0, 0, numColumns - cursor, height, cursor, 0, numColumns - cursor, height);
+			g.drawImage(scopeImg, numColumns - cursor, 0, cursor, height, 0, 0, cursor, height);
+			g.setColour(juce::Colours::rebeccapurple);
+			g.drawRect(getLocalBounds());
+			for (const auto value : curValue)
+				g.fillEllipse(getPointBounds(value));
+		}
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LFODisplay)
+	};
+
+	/*
+	* min/max history of the parameter under the mouse, or of the last one that was.
+	* a click opens or closes it, the matrix only captures the history while it's open and showing
+	*/
+	struct ParameterHistoryDisplay :
+		public juce::Component
+	{
+		static constexpr int NumBlocks = 2048; // history that fits into the display
+
+		ParameterHistoryDisplay(ModularTestAudioProcessor& p) :
+			processor(p),
+			gate(),
+			history(nullptr),
+			columns(),
+			pHandle(-1),
+			name(),
+			wantsOpen(false)
+		{}
+		~ParameterHistoryDisplay() { setOpen(false); }
+		void timerCallback(modSys2::Matrix& matrix) {
+			if (gate == nullptr) return;
+			// prepareToPlay replaced the gate
+			if (matrix.getHistory() != gate) {
+				gate->close();
+				open(matrix.getHistory());
+			}
+			if (auto p = getParameterUnderMouse())
+				if (p->handle != pHandle) {
+					pHandle = p->handle;
+					name = processor.apvts.getParameter(p->id.toString())->getName(32);
+				}
+			repaint();
+		}
+	protected:
+		ModularTestAudioProcessor& processor;
+		std::shared_ptr<modSys2::ParameterHistoryGate> gate; // keeps history alive, nullptr while closed
+		const modSys2::ParameterHistory* history;
+		std::vector<modSys2::ParameterHistory::Entry> columns;
+		int pHandle;
+		juce::String name;
+		bool wantsOpen;
+
+		void setOpen(const bool o) {
+			if (o == (gate != nullptr)) return;
+			if (o) open(processor.matrix.getUpdatedPtr()->getHistory());
+			else {
+				gate->close();
+				gate = nullptr;
+				history = nullptr;
+			}
+			repaint();
+		}
+		void open(const std::shared_ptr<modSys2::ParameterHistoryGate>& g) {
+			gate = g;
+			history = gate->open();
+		}
+		Parameter* getParameterUnderMouse() const {
+			auto c = juce::Desktop::getInstance().getMainMouseSource().getComponentUnderMouse();
+			if (c == nullptr) return nullptr;
+			if (auto p = dynamic_cast<Parameter*>(c)) return p;
+			return c->findParentComponentOfClass<Parameter>();
+		}
+
+		void mouseUp(const juce::MouseEvent&) override {
+			wantsOpen = !wantsOpen;
+			setOpen(wantsOpen && isShowing());
+		}
+		void resized() override { columns.resize(static_cast<size_t>(std::max(1, getWidth()))); }
+		void visibilityChanged() override { setOpen(wantsOpen && isShowing()); }
+		void parentHierarchyChanged() override { setOpen(wantsOpen && isShowing()); }
+
+		/* the blocks captured so far are drawn at the right edge, they fill the display once there are NumBlocks */
+		void paint(juce::Graphics& g) override {
 			const auto height = static_cast<float>(getHeight());
-			g0.fillAll(juce::Colour(0x77000000));
-			g0.setColour(juce::Colours::rebeccapurple);
-			g0.drawRect(getLocalBounds());
-			for (auto ch = 0; ch < curValue.size(); ++ch) {
-				const auto x = curValue[ch] * width;
-				const auto y = height - curValue[ch] * height;
-				juce::Rectangle<float> valuePt(x - 1, y - 1, 3, 3);
-				g0.fillEllipse(valuePt);
+			const auto width = static_cast<int>(columns.size());
+			g.setColour(juce::Colours::rebeccapurple);
+			g.drawRect(getLocalBounds());
+			g.setColour(juce::Colours::white);
+			if (history == nullptr) {
+				g.drawFittedText("history", getLocalBounds(), juce::Justification::centred, 1);
+				return;
+			}
+			g.drawFittedText(name, getLocalBounds(), juce::Justification::centredTop, 1);
+			auto numColumns = width;
+			const auto numCovered = history->read(pHandle, NumBlocks, columns.data(), numColumns);
+			if (numCovered == 0) return;
+			if (numCovered < NumBlocks) {
+				numColumns = std::max(1, width * numCovered / NumBlocks);
+				history->read(pHandle, numCovered, columns.data(), numColumns);
+			}
+			g.setColour(juce::Colours::darkslateblue);
+			for (auto c = 0; c < numColumns; ++c) {
+				const auto& e = columns[c];
+				g.drawVerticalLine(width - numColumns + c, height - e.max * height, height - e.min * height + 1.f);
 			}
-			g.drawImageAt(img, 0, 0, false);
 		}
-		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LFODisplay)
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterHistoryDisplay)
+	};
+	/*
+	* what the editor needs to know about a modulator to build its widgets
+	*/
+	struct ModuleInfo {
+		juce::String id, type;
+		int handle;
+		bool acceptsAudio;
+		juce::StringArray parameterIDs;
+
+		bool operator==(const ModuleInfo& other) const noexcept { return handle == other.handle && id == other.id && type == other.type; }
+		bool operator!=(const ModuleInfo& other) const noexcept { return !(*this == other); }
+
+		/* the macros or all other modulators of the matrix, in handle order */
+		static std::vector<ModuleInfo> getModules(modSys2::Matrix& matrix, const bool macros) {
+			std::vector<ModuleInfo> modules;
+			for (auto h = 0; h < matrix.getNumModulatorHandles(); ++h) {
+				const auto mod = matrix.getModulator(h);
+				if (mod == nullptr) continue;
+				const juce::String type(mod->getTypeName());
+				if ((type == "Macro") != macros) continue;
+				ModuleInfo info{ mod->id.toString(), type, h, mod->acceptsAudio(), {} };
+				for (const auto& p : mod->getParameters())
+					info.parameterIDs.add(p->id.toString());
+				modules.push_back(info);
+			}
+			return modules;
+		}
+	};
+
+	/*
+	* one modulator in the module list: dragger(s), input bus, display and parameters.
+	* the list recycles rows, so bind only rebuilds the children if the row shows another modulator,
+	* but always flags its handles so the next timerCallback fills them in
+	*/
+	struct ModuleRow :
+		public juce::Component
+	{
+		static constexpr int MinColumns = 10;
+
+		ModuleRow(ModularTestAudioProcessor& p, TargetGrid& targets, const int channels) :
+			processor(p),
+			targetGrid(targets),
+			numChannels(channels),
+			module(),
+			draggers(),
+			inputBus(),
+			envFolDisplay(),
+			lfoDisplay(),
+			parameters()
+		{ setInterceptsMouseClicks(false, true); }
+		void bind(const ModuleInfo& info) {
+			if (module != info)
+				rebuild(info);
+			// the children only update themselves when their handles are flagged.
+			// a recycled row may have missed changes while it was off screen, so always flag
+			const auto matrix = processor.matrix.getUpdatedPtr();
+			matrix->flagChanged(module.handle, -1);
+			for (const auto& p : parameters)
+				matrix->flagChanged(-1, p->handle);
+		}
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			for (auto& d : draggers) d->timerCallback(matrix, snapshot, changed);
+			if (inputBus != nullptr) inputBus->timerCallback(matrix, snapshot, changed);
+			if (envFolDisplay != nullptr) envFolDisplay->timerCallback(matrix, snapshot, changed);
+			if (lfoDisplay != nullptr) lfoDisplay->timerCallback(matrix, snapshot, changed);
+			for (auto& p : parameters) p->timerCallback(matrix, snapshot, changed);
+		}
+		void getTargets(std::vector<Parameter*>& targets) const {
+			for (const auto& p : parameters) targets.push_back(p.get());
+		}
+	protected:
+		void rebuild(const ModuleInfo& info) {
+			module = info;
+			draggers.clear();
+			inputBus.reset();
+			envFolDisplay.reset();
+			lfoDisplay.reset();
+			parameters.clear();
+
+			if (module.type == "EnvFol")
+				envFolDisplay = std::make_unique<EnvelopeFollowerDisplay>(processor, module.id, numChannels, 0);
+			else if (module.type == "MBEnvFol")
+				envFolDisplay = std::make_unique<EnvelopeFollowerDisplay>(processor, module.id,
+					modSys2::MultibandEnvelopeFollowerModulator::NumBands, modSys2::ChannelSetup::Band0);
+			else if (module.type == "LFO" || module.type == "Rand" || module.type == "Perlin")
+				lfoDisplay = std::make_unique<LFODisplay>(processor, module.id, numChannels);
+			if (auto display = getDisplay()) addAndMakeVisible(display);
+
+			for (const auto& pID : module.parameterIDs) {
+				parameters.push_back(std::make_unique<ParameterExample>(processor, pID, numChannels));
+				addAndMakeVisible(*parameters.back());
+			}
+			if (module.acceptsAudio) {
+				inputBus = std::make_unique<InputBusButton>(processor, module.id);
+				addAndMakeVisible(*inputBus);
+			}
+			if (module.type == "MBEnvFol")
+				for (auto b = 0; b < modSys2::MultibandEnvelopeFollowerModulator::NumBands; ++b)
+					draggers.push_back(std::make_unique<ModulatorDragger>(processor, module.id, targetGrid,
+						modSys2::ChannelSetup(modSys2::ChannelSetup::Band0 + b)));
+			else
+				draggers.push_back(std::make_unique<ModulatorDragger>(processor, module.id, targetGrid));
+			for (auto& d : draggers) addAndMakeVisible(*d);
+			resized();
+		}
+		ModularTestAudioProcessor& processor;
+		TargetGrid& targetGrid;
+		const int numChannels;
+		ModuleInfo module;
+		std::vector<std::unique_ptr<ModulatorDragger>> draggers;
+		std::unique_ptr<InputBusButton> inputBus;
+		std::unique_ptr<EnvelopeFollowerDisplay> envFolDisplay;
+		std::unique_ptr<LFODisplay> lfoDisplay;
+		std::vector<std::unique_ptr<ParameterExample>> parameters;
+
+		juce::Component* getDisplay() const noexcept {
+			if (envFolDisplay != nullptr) return envFolDisplay.get();
+			return lfoDisplay.get();
+		}
+		/* dragger and input bus share the first column, unless there are band draggers to fit in */
+		void resized() override {
+			const auto numColumns = std::max(MinColumns, 2 + static_cast<int>(parameters.size()));
+			const auto width = static_cast<float>(getWidth()) / numColumns;
+			const auto height = static_cast<float>(getHeight());
+			const auto draggerWidth = width * .5f;
+			auto x = 0.f;
+			if (draggers.size() == 1) {
+				draggers[0]->setQBounds(maxQuadIn(juce::Rectangle<float>(x, 0.f, draggerWidth, height)).toNearestInt());
+				if (inputBus != nullptr)
+					inputBus->setBounds(juce::Rectangle<float>(x + draggerWidth, 0.f, draggerWidth, height).toNearestInt());
+			}
+			else {
+				const auto draggerHeight = height * .5f;
+				for (auto d = 0; d < draggers.size(); ++d)
+					draggers[d]->setQBounds(maxQuadIn(juce::Rectangle<float>(x + (d % 2) * draggerWidth,
+						(d / 2) * draggerHeight, draggerWidth, draggerHeight)).toNearestInt());
+			}
+			x += width;
+			if (auto display = getDisplay())
+				display->setBounds(maxQuadIn(juce::Rectangle<float>(x, 0.f, width, height)).toNearestInt());
+			x += width;
+			for (auto& p : parameters) {
+				p->setBounds(maxQuadIn(juce::Rectangle<float>(x, 0.f, width, height)).toNearestInt());
+				x += width;
+			}
+			if (draggers.size() != 1 && inputBus != nullptr)
+				inputBus->setBounds(juce::Rectangle<float>(x, 0.f, draggerWidth, height).toNearestInt());
+		}
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModuleRow)
+	};
+
+	/*
+	* scrolling list of every modulator but the macros, generated from the matrix. only rows
+	* on screen have components and the list box recycles them, so opening the editor
+	* costs the same no matter how many modulators there are
+	*/
+	struct ModuleList :
+		public juce::Component,
+		public juce::ListBoxModel
+	{
+		ModuleList(ModularTestAudioProcessor& p, TargetGrid& targets, const int channels) :
+			processor(p),
+			targetGrid(targets),
+			numChannels(channels),
+			modules(),
+			generation(-1),
+			listBox("Modules", this)
+		{
+			listBox.setColour(juce::ListBox::backgroundColourId, juce::Colours::black);
+			addAndMakeVisible(listBox);
+			update();
+		}
+		void setRowHeight(const int height) { listBox.setRowHeight(std::max(1, height)); }
+		/* picks up slots that were set or freed, then updates the rows on screen */
+		void timerCallback(modSys2::Matrix& matrix, const modSys2::UISnapshot& snapshot, const modSys2::ChangeFlags::Set& changed) {
+			update();
+			forEachRowOnScreen([&](ModuleRow& row) { row.timerCallback(matrix, snapshot, changed); });
+		}
+		void getTargets(std::vector<Parameter*>& targets) {
+			forEachRowOnScreen([&](ModuleRow& row) { row.getTargets(targets); });
+		}
+
+		int getNumRows() override { return static_cast<int>(modules.size()); }
+		void paintListBoxItem(int, juce::Graphics&, int, int, bool) override {}
+		juce::Component* refreshComponentForRow(const int rowNumber, const bool, juce::Component* existing) override {
+			if (rowNumber < 0 || rowNumber >= modules.size()) {
+				delete existing;
+				return nullptr;
+			}
+			// the list box only holds rows made here
+			auto row = static_cast<ModuleRow*>(existing);
+			if (row == nullptr)
+				row = new ModuleRow(processor, targetGrid, numChannels);
+			row->bind(modules[rowNumber]);
+			return row;
+		}
+	protected:
+		ModularTestAudioProcessor& processor;
+		TargetGrid& targetGrid;
+		const int numChannels;
+		std::vector<ModuleInfo> modules;
+		int generation;
+		juce::ListBox listBox;
+
+		void resized() override { listBox.setBounds(getLocalBounds()); }
+		/* the matrix' generation changes with every edit, but the modules rarely do */
+		void update() {
+			const auto matrix = processor.matrix.getUpdatedPtr();
+			const auto g = matrix->getGeneration();
+			if (g == generation) return;
+			generation = g;
+			auto m = ModuleInfo::getModules(*matrix, false);
+			if (m == modules) return;
+			modules = std::move(m);
+			listBox.updateContent();
+		}
+		template<typename Func>
+		void forEachRowOnScreen(Func&& func) {
+			for (auto r = std::max(0, listBox.getRowContainingPosition(0, 0)); r < modules.size(); ++r)
+				if (auto row = listBox.getComponentForRowNumber(r))
+					func(*static_cast<ModuleRow*>(row));
+				else return;
+		}
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModuleList)
 	};
 }
\ No newline at end of file
@@ -16,33 +16,22 @@ struct ModularTestAudioProcessorEditor :
     public juce::Timer
 {
     ModularTestAudioProcessorEditor (ModularTestAudioProcessor&);
+    ~ModularTestAudioProcessorEditor() override;
 protected:
     ModularTestAudioProcessor& audioProcessor;
 
     juce::Label macrosLabel;
-    modSys2Editor::ParameterExample macro0P, macro1P, macro2P, macro3P;
+    std::vector<std::unique_ptr<modSys2Editor::ParameterExample>> macros;
 
     juce::Label globalsLabel;
-    modSys2Editor::ParameterExample depthP, modulesMixP;
-
-    modSys2Editor::ParameterExample envFolGainP, envFolAtkP, envFolRlsP, envFolBiasP, envFolWdthP;
-    modSys2Editor::EnvelopeFollowerDisplay envFolDisplay;
-
-    modSys2Editor::ParameterExample lfoSyncP, lfoRateP, lfoWdthP, lfoWaveTableP;
-    modSys2Editor::LFODisplay lfoDisplay;
-
-    modSys2Editor::ParameterExample randSyncP, randRateP, randBiasP, randWidthP, randSmoothP;
-    modSys2Editor::LFODisplay randDisplay;
-
-    modSys2Editor::ParameterExample perlinSyncP, perlinRateP, perlinOctavesP, perlinWidthP;
-    modSys2Editor::LFODisplay perlinDisplay;
+    modSys2Editor::ParameterExample depthP, modulesMixP, envFolDecimationP;
+    modSys2Editor::ParameterHistoryDisplay historyDisplay;
 
     juce::Label modulesLabel;
 
-    std::vector<modSys2Editor::Parameter*> modulatableParameters;
-
-    modSys2Editor::ModulatorDragger macro0Dragger, macro1Dragger, macro2Dragger, macro3Dragger;
-    modSys2Editor::ModulatorDragger envFolDragger, lfoDragger, randDragger, perlinDragger;
+    modSys2Editor::TargetGrid targetGrid;
+    modSys2Editor::ModuleList modules;
+    std::vector<std::unique_ptr<modSys2Editor::ModulatorDragger>> macroDraggers;
 
     void paint(juce::Graphics&) override;
     void resized() override;
@@ -10,19 +10,31 @@ ModularTestAudioProcessor::ModularTestAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        ),
     lfoFreeSyncRanges(),
     apvts(*this, nullptr, "Params", param::createParameters(apvts, lfoFreeSyncRanges)),
-    matrix(apvts)
+    matrix(modSys2::Matrix(apvts, param::getIDs())),
+    lookaheadDelay(),
+    parametersGeneration(0),
+    stateCache(),
+    onStateLoaded(),
+    stateLoads(0),
+    lifetime(std::make_shared<int>(0)),
+    stateLoader(1)
 #endif
 {
+    for (auto p : getParameters())
+        p->addListener(this);
+
     matrix->addMacroModulator(param::getID(param::ID::Macro0));
     matrix->addMacroModulator(param::getID(param::ID::Macro1));
     matrix->addMacroModulator(param::getID(param::ID::Macro2));
     matrix->addMacroModulator(param::getID(param::ID::Macro3));
+    matrix->setGlobalParameters(param::getHandle(param::ID::Depth), param::getHandle(param::ID::ModulesMix));
 
     matrix->addEnvelopeFollowerModulator(
         param::getID(param::ID::EnvFolGain),
@@ -30,6 +42,19 @@ ModularTestAudioProcessor::ModularTestAudioProcessor()
         param::getID(param::ID::EnvFolRls),
         param::getID(param::ID::EnvFolBias),
         param::getID(param::ID::EnvFolWdth),
+        param::getID(param::ID::EnvFolDetector),
+        param::getID(param::ID::EnvFolWindow),
+        param::getID(param::ID::EnvFolLookahead),
+        param::getID(param::ID::EnvFolDecimation),
+        0
+    );
+    matrix->addMultibandEnvelopeFollowerModulator(
+        param::getID(param::ID::MBEnvFolGain),
+        param::getID(param::ID::MBEnvFolAtk),
+        param::getID(param::ID::MBEnvFolRls),
+        param::getID(param::ID::MBEnvFolXLow),
+        param::getID(param::ID::MBEnvFolXMid),
+        param::getID(param::ID::MBEnvFolXHigh),
         0
     );
     auto lfoMod = matrix->addLFOModulator(
@@ -63,10 +88,31 @@ ModularTestAudioProcessor::ModularTestAudioProcessor()
         param::getID(param::ID::PerlinRate),
         param::getID(param::ID::PerlinOctaves),
         param::getID(param::ID::PerlinWdth),
+        param::getID(param::ID::PerlinNoise),
         lfoFreeSyncRanges,
         maxOctaves,
         0
     );
+
+    matrix->initSlots(param::NumParams, param::NumSlots, param::ParamsPerSlot);
+    using SlotParams = std::vector<std::shared_ptr<modSys2::Parameter>>;
+    matrix->addSlotType("EnvFol", param::getRanges({
+        param::ID::EnvFolGain, param::ID::EnvFolAtk, param::ID::EnvFolRls, param::ID::EnvFolBias, param::ID::EnvFolWdth,
+        param::ID::EnvFolDetector, param::ID::EnvFolWindow, param::ID::EnvFolLookahead
+    }), [decimationP = matrix->getParameter(param::getID(param::ID::EnvFolDecimation))](const juce::String& mID, const SlotParams& p) {
+        return std::make_shared<modSys2::EnvelopeFollowerModulator>(mID, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], decimationP);
+    });
+    matrix->addSlotType("LFO", param::getRanges(param::ID::LFOSync, 4), [this, waveTableInfo](const juce::String& mID, const SlotParams& p) {
+        auto mod = std::make_shared<modSys2::LFOModulator>(mID, p[0], p[1], p[2], p[3], lfoFreeSyncRanges);
+        mod->addStuff("wavetables", waveTableInfo);
+        return mod;
+    });
+    matrix->addSlotType("Rand", param::getRanges(param::ID::RandSync, 5), [this](const juce::String& mID, const SlotParams& p) {
+        return std::make_shared<modSys2::RandomModulator>(mID, p[0], p[1], p[2], p[3], p[4], lfoFreeSyncRanges);
+    });
+    matrix->addSlotType("Perlin", param::getRanges(param::ID::PerlinSync, 5), [this, maxOctaves](const juce::String& mID, const SlotParams& p) {
+        return std::make_shared<modSys2::PerlinModulator>(mID, p[0], p[1], p[2], p[3], p[4], lfoFreeSyncRanges, maxOctaves);
+    });
 #if DebugRefCount
     matrix.dbgReferenceCount("CONSTR");
 #endif
@@ -74,6 +120,8 @@ ModularTestAudioProcessor::ModularTestAudioProcessor()
 
 ModularTestAudioProcessor::~ModularTestAudioProcessor()
 {
+    for (auto p : getParameters())
+        p->removeListener(this);
 }
 
 //==============================================================================
@@ -149,13 +197,12 @@ void ModularTestAudioProcessor::prepareToPlay(double sampleRate, int samplesPerB
     m->prepareToPlay(getChannelCountOfBus(false, 0), samplesPerBlock, sampleRate);
 
     auto sec = (float)sampleRate;
-    m->setSmoothingLengthInSamples(param::getID(param::ID::LFOSync), 0); // example for snappy param
-    m->setSmoothingLengthInSamples(param::getID(param::ID::LFOWaveTable), 0);
-    m->setSmoothingLengthInSamples(param::getID(param::ID::ModulesMix), sec / 8); // example for quick param
-    m->setSmoothingLengthInSamples(param::getID(param::ID::Depth), sec); // example for slow param
-    m->setSmoothingLengthInSamples(param::getID(param::ID::EnvFolAtk), sec / 64);
-    m->setSmoothingLengthInSamples(param::getID(param::ID::EnvFolRls), sec / 64);
-    m->setSmoothingLengthInSamples(param::getID(param::ID::EnvFolWdth), sec / 64);
+    for (const auto& d : param::descriptors)
+        m->setSmoothingLengthInSamples(param::getHandle(d.id), d.smoothing * sec);
+
+    const auto latency = m->getLatencySamples();
+    lookaheadDelay.prepare(getTotalNumOutputChannels(), latency);
+    setLatencySamples(latency);
 
     matrix.replaceUpdatedPtrWith(m);
 #if DebugRefCount
@@ -188,6 +235,15 @@ bool ModularTestAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain is optional, but only mono or stereo
+    if (layouts.inputBuses.size() > 1) {
+        const auto sidechain = layouts.getChannelSet(true, 1);
+        if (!sidechain.isDisabled()
+         && sidechain != juce::AudioChannelSet::mono()
+         && sidechain != juce::AudioChannelSet::stereo())
+            return false;
+    }
    #endif
 
     return true;
@@ -203,53 +259,187 @@ void ModularTestAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    // bus buffers only point into buffer, nothing gets copied
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+    const auto mainInput = getBusBuffer(buffer, true, 0);
+    const auto sidechain = getBusCount(true) > 1 ? getBusBuffer(buffer, true, 1) : juce::AudioBuffer<float>();
+    const std::array<modSys2::AudioInput, 2> inputs{{
+        { mainInput.getArrayOfReadPointers(), mainInput.getNumChannels() },
+        { sidechain.getArrayOfReadPointers(), sidechain.getNumChannels() }
+    }};
+
     auto mtrx = matrix.updateAndLoadCurrentPtr();
-    mtrx->processBlock(buffer, getPlayHead());
+    mtrx->processBlock(mainBuffer, inputs.data(), static_cast<int>(inputs.size()), getPlayHead());
+    lookaheadDelay.processBlock(mainBuffer);
 }
 
 bool ModularTestAudioProcessor::hasEditor() const { return true; }
 juce::AudioProcessorEditor* ModularTestAudioProcessor::createEditor() { return new ModularTestAudioProcessorEditor (*this); }
 
+/*
+* binary state: header, the normalized values of all parameters in handle order,
+* then the matrix' routings. see modSys2::BinaryState
+*/
 void ModularTestAudioProcessor::getStateInformation (juce::MemoryBlock& destData) {
-    // VALUETREE TO BINARY
-    matrix->getState(apvts);
+    const juce::ScopedLock sl(stateCache.lock);
+    const auto flags = modSys2::BinaryState::QuantizedAttenuvertors;
+    // generations are read before encoding, so edits made meanwhile dirty the next call.
+    // the routings' one comes from the same copy of the matrix that gets written
+    const auto paramsGen = parametersGeneration.get();
+    const auto updated = matrix.getUpdatedPtr();
+    const auto routingsGen = updated->getGeneration();
+    const auto paramsDirty = paramsGen != stateCache.parametersGeneration;
+    const auto routingsDirty = routingsGen != stateCache.routingsGeneration;
+    if (paramsDirty) {
+        // values go with their ids, so added or reordered parameters don't shift them
+        juce::MemoryOutputStream out(stateCache.parameters, false);
+        const auto& params = getParameters();
+        modSys2::BinaryState::writeVarInt(out, static_cast<int>(params.size()));
+        for (const auto p : params) {
+            out.writeString(static_cast<juce::RangedAudioParameter*>(p)->paramID);
+            out.writeFloat(p->getValue());
+        }
+        stateCache.parametersGeneration = paramsGen;
+    }
+    // routings that are still being loaded are handed back as they came in
+    const auto loading = stateCache.pendingLoad != 0;
+    if (routingsDirty && !loading) {
 #if DebugRefCount
-    matrix.dbgReferenceCount("GET STATE");
+        matrix.dbgReferenceCount("GET STATE");
 #endif
+        juce::MemoryOutputStream out(stateCache.routings, false);
+        updated->writeState(out, flags);
+        stateCache.routingsGeneration = routingsGen;
+    }
+    if (paramsDirty || routingsDirty || loading) {
+        juce::MemoryOutputStream out(stateCache.blob, false);
+        modSys2::BinaryState::writeHeader(out, flags);
+        modSys2::BinaryState::writeSection(out, stateCache.parameters);
+        modSys2::BinaryState::writeSection(out, loading ? stateCache.pendingRoutings : stateCache.routings);
+    }
+    destData = stateCache.blob;
+}
 
-#if ResetAPVTS
-    apvts.state.removeAllChildren(nullptr);
-    apvts.state.removeAllProperties(nullptr);
+void ModularTestAudioProcessor::setStateInformation (const void* data, int sizeInBytes) {
+    if (!modSys2::BinaryState::isBinaryState(data, sizeInBytes))
+        return setStateInformationFromXml(data, sizeInBytes);
+
+    // incomplete states are discarded as a whole
+    juce::MemoryInputStream in(data, static_cast<size_t>(sizeInBytes), false);
+    const auto flags = modSys2::BinaryState::readHeader(in);
+    if (flags == -1) return;
+    juce::MemoryBlock parameters, routings;
+    if (!modSys2::BinaryState::readSection(in, parameters) || !modSys2::BinaryState::readSection(in, routings))
+        return;
+
+    juce::MemoryInputStream paramsIn(parameters, false);
+    const auto numParams = modSys2::BinaryState::readVarInt(paramsIn);
+    std::vector<std::pair<juce::RangedAudioParameter*, float>> values;
+    for (auto p = 0; p < numParams; ++p) {
+        if (paramsIn.isExhausted()) return;
+        const auto id = paramsIn.readString();
+        if (paramsIn.getNumBytesRemaining() < 4) return;
+        const auto value = paramsIn.readFloat();
+        // parameters that don't exist anymore are skipped, new ones keep their value
+        if (auto param = apvts.getParameter(id))
+            values.emplace_back(param, value);
+    }
+    for (const auto& v : values)
+        v.first->setValueNotifyingHost(v.second);
+
+    loadRoutingsAsync(std::move(routings), flags);
+}
+
+/*
+* decodes the routings on the loader thread. the slots are set on a copy of the matrix on the
+* message thread, where all other edits happen too, then the loader thread brings that copy's
+* destinations up to date and the message thread swaps it in. if the matrix got edited meanwhile
+* the routings are applied again to a fresh copy. loads that got overtaken by a newer one are
+* skipped. until a load is done, the state returns its routings
+*/
+void ModularTestAudioProcessor::loadRoutingsAsync(juce::MemoryBlock&& routings, const int flags) {
+    const auto load = ++stateLoads;
+    {
+        const juce::ScopedLock sl(stateCache.lock);
+        stateCache.pendingRoutings = routings;
+        stateCache.pendingLoad = load;
+    }
+    std::weak_ptr<int> alive(lifetime);
+    const auto updated = matrix.getUpdatedPtr();
+    stateLoader.addJob([this, routings = std::move(routings), flags, layout = updated->getLayout(),
+        numSlots = updated->getNumSlots(), load, alive]() {
+        if (load != stateLoads.get()) return;
+        juce::MemoryInputStream in(routings, false);
+        modSys2::RoutingState state;
+        // cut off or malformed, then the current routings stay
+        if (!state.read(in, flags, layout, numSlots)) {
+            juce::MessageManager::callAsync([this, load, alive]() {
+                if (alive.lock() != nullptr && load == stateLoads.get())
+                    finishStateLoad();
+            });
+            return;
+        }
+        juce::MessageManager::callAsync([this, state = std::move(state), load, alive]() {
+            if (alive.lock() == nullptr || load != stateLoads.get()) return;
+            // BINARY TO MATRIX
+#if DebugRefCount
+            matrix.dbgReferenceCount("SET STATE");
+#endif
+            const auto base = matrix.getUpdatedPtr();
+            const auto baseGeneration = base->getGeneration();
+            auto m = std::make_shared<modSys2::Matrix>(*base);
+            m->applySlots(state);
+            stateLoader.addJob([this, m, state, base, baseGeneration, load, alive]() {
+                if (load != stateLoads.get()) return;
+                m->applyRoutings(state);
+                juce::MessageManager::callAsync([this, m, state, base, baseGeneration, load, alive]() {
+                    if (alive.lock() == nullptr || load != stateLoads.get()) return;
+                    auto loaded = m;
+                    // replaced (e.g. by prepareToPlay) or edited in place since the copy
+                    if (matrix.getUpdatedPtr() != base || base->getGeneration() != baseGeneration) {
+                        loaded = matrix.getCopyOfUpdatedPtr();
+                        loaded->applyState(state);
+                    }
+                    matrix.replaceUpdatedPtrWith(loaded);
+#if DebugRefCount
+                    matrix.dbgReferenceCount("SET STATE AFTER REPLACE");
 #endif
+                    finishStateLoad();
+                });
+            });
+        });
+    });
+}
 
-    auto state = apvts.copyState();
-    std::unique_ptr<juce::XmlElement> xml(state.createXml());
-    copyXmlToBinary(*xml, destData);
+void ModularTestAudioProcessor::finishStateLoad() {
+    {
+        const juce::ScopedLock sl(stateCache.lock);
+        stateCache.pendingRoutings.reset();
+        stateCache.pendingLoad = 0;
+        stateCache.routingsGeneration = -1;
+    }
+    if (onStateLoaded)
+        onStateLoaded();
 }
 
-void ModularTestAudioProcessor::setStateInformation (const void* data, int sizeInBytes) {
+void ModularTestAudioProcessor::parameterValueChanged(int, float) {
+    ++parametersGeneration;
+}
+
+/* sessions saved before the binary state */
+void ModularTestAudioProcessor::setStateInformationFromXml(const void* data, int sizeInBytes) {
     std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName(apvts.state.getType()))
             apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
 
-#if ResetAPVTS
-    apvts.state.removeAllChildren(nullptr);
-    apvts.state.removeAllProperties(nullptr);
-#endif
-
-    // BINARY TO VALUETREE
-#if DebugRefCount
-    matrix.dbgReferenceCount("SET STATE");
-#endif
     auto m = matrix.getCopyOfUpdatedPtr();
-#if DebugRefCount
-    matrix.dbgReferenceCount("SET STATE AFTER COPY");
-#endif
     m->setState(apvts);
     matrix.replaceUpdatedPtrWith(m);
-#if DebugRefCount
-    matrix.dbgReferenceCount("SET STATE AFTER REPLACE");
+
+#if ResetAPVTS
+    apvts.state.removeAllChildren(nullptr);
+    apvts.state.removeAllProperties(nullptr);
 #endif
 }
 
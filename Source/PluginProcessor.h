@@ -7,41 +7,142 @@ namespace param {
 		EnvFolGain, EnvFolAtk, EnvFolRls, EnvFolBias, EnvFolWdth,
 		LFOSync, LFORate, LFOWdth, LFOWaveTable,
 		RandSync, RandRate, RandBias, RandWdth, RandSmooth,
-		PerlinSync, PerlinRate, PerlinOctaves, PerlinWdth
+		PerlinSync, PerlinRate, PerlinOctaves, PerlinWdth, PerlinNoise,
+		EnvFolDetector, EnvFolWindow, EnvFolLookahead,
+		MBEnvFolGain, MBEnvFolAtk, MBEnvFolRls, MBEnvFolXLow, MBEnvFolXMid, MBEnvFolXHigh,
+		EnvFolDecimation
 	};
 
-	static juce::String getName(ID i) {
-		switch (i) {
-		case ID::Macro0: return "Macro 0";
-		case ID::Macro1: return "Macro 1";
-		case ID::Macro2: return "Macro 2";
-		case ID::Macro3: return "Macro 3";
-		case ID::Depth: return "Depth";
-		case ID::ModulesMix: return "ModulesMix";
-		case ID::EnvFolGain: return "EnvFolGain";
-		case ID::EnvFolAtk: return "EnvFolAtk";
-		case ID::EnvFolRls: return "EnvFolRls";
-		case ID::EnvFolBias: return "EnvFolBias";
-		case ID::EnvFolWdth: return "EnvFolWdth";
-		case ID::LFOSync: return "LFOSync";
-		case ID::LFORate: return "LFORate";
-		case ID::LFOWdth: return "LFOWdth";
-		case ID::LFOWaveTable: return "LFOWaveTable";
-		case ID::RandSync: return "RandSync";
-		case ID::RandRate: return "RandRate";
-		case ID::RandBias: return "RandBias";
-		case ID::RandWdth: return "RandWdth";
-		case ID::RandSmooth: return "RandSmooth";
-		case ID::PerlinSync: return "PerlinSync";
-		case ID::PerlinRate: return "PerlinRate";
-		case ID::PerlinOctaves: return "PerlinOctaves";
-		case ID::PerlinWdth: return "PerlinWdth";
-		default: return "";
+	/* how a parameter's value is shown, and for Sync/Rate also how it gets created */
+	enum class Unit { Percent, Ms, Db, Hz, Octaves, Detector, WaveTable, Noise, Sync, Rate };
+
+	/*
+	* everything needed to create, identify and smooth a parameter.
+	* link is the sync parameter a rate parameter looks at. smoothing is in seconds
+	*/
+	struct Descriptor {
+		ID id;
+		const char* name;
+		const char* lowerID;
+		float defaultValue;
+		float min, max, interval, skew;
+		Unit unit;
+		ID link;
+		float smoothing;
+	};
+
+	static constexpr Descriptor descriptors[] = {
+		{ ID::Macro0, "Macro 0", "macro0", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::Macro0, 0.f },
+		{ ID::Macro1, "Macro 1", "macro1", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::Macro1, 0.f },
+		{ ID::Macro2, "Macro 2", "macro2", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::Macro2, 0.f },
+		{ ID::Macro3, "Macro 3", "macro3", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::Macro3, 0.f },
+		{ ID::Depth, "Depth", "depth", 1.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::Depth, 1.f },
+		{ ID::ModulesMix, "ModulesMix", "modulesmix", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::ModulesMix, 1.f / 8.f },
+
+		{ ID::EnvFolGain, "EnvFolGain", "envfolgain", 1.f, 0.f, 24.f, 0.f, 1.f, Unit::Db, ID::EnvFolGain, 0.f },
+		{ ID::EnvFolAtk, "EnvFolAtk", "envfolatk", 1.f, 6.f, 1000.f, 0.f, 1.f, Unit::Ms, ID::EnvFolAtk, 1.f / 64.f },
+		{ ID::EnvFolRls, "EnvFolRls", "envfolrls", .5f, 6.f, 1000.f, 0.f, 1.f, Unit::Ms, ID::EnvFolRls, 1.f / 64.f },
+		{ ID::EnvFolBias, "EnvFolBias", "envfolbias", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::EnvFolBias, 0.f },
+		{ ID::EnvFolWdth, "EnvFolWdth", "envfolwdth", 1.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::EnvFolWdth, 1.f / 64.f },
+
+		{ ID::LFOSync, "LFOSync", "lfosync", 0.f, 0.f, 1.f, 1.f, 1.f, Unit::Sync, ID::LFOSync, 0.f },
+		{ ID::LFORate, "LFORate", "lforate", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Rate, ID::LFOSync, 0.f },
+		{ ID::LFOWdth, "LFOWdth", "lfowdth", 0.f, -1.f, 1.f, 0.f, 1.f, Unit::Percent, ID::LFOWdth, 0.f },
+		{ ID::LFOWaveTable, "LFOWaveTable", "lfowavetable", 0.f, 0.f, 2.f, 1.f, 1.f, Unit::WaveTable, ID::LFOWaveTable, 0.f },
+
+		{ ID::RandSync, "RandSync", "randsync", 0.f, 0.f, 1.f, 1.f, 1.f, Unit::Sync, ID::RandSync, 0.f },
+		{ ID::RandRate, "RandRate", "randrate", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Rate, ID::RandSync, 0.f },
+		{ ID::RandBias, "RandBias", "randbias", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::RandBias, 0.f },
+		{ ID::RandWdth, "RandWdth", "randwdth", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::RandWdth, 0.f },
+		{ ID::RandSmooth, "RandSmooth", "randsmooth", 1.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::RandSmooth, 0.f },
+
+		{ ID::PerlinSync, "PerlinSync", "perlinsync", 0.f, 0.f, 1.f, 1.f, 1.f, Unit::Sync, ID::PerlinSync, 0.f },
+		{ ID::PerlinRate, "PerlinRate", "perlinrate", .5f, 0.f, 1.f, 0.f, 1.f, Unit::Rate, ID::PerlinSync, 0.f },
+		{ ID::PerlinOctaves, "PerlinOctaves", "perlinoctaves", 1.f, 1.f, 8.f, 1.f, 1.f, Unit::Octaves, ID::PerlinOctaves, 0.f },
+		{ ID::PerlinWdth, "PerlinWdth", "perlinwdth", 0.f, 0.f, 1.f, 0.f, 1.f, Unit::Percent, ID::PerlinWdth, 0.f },
+		{ ID::PerlinNoise, "PerlinNoise", "perlinnoise", 0.f, 0.f, 1.f, 1.f, 1.f, Unit::Noise, ID::PerlinNoise, 0.f },
+
+		{ ID::EnvFolDetector, "EnvFolDetector", "envfoldetector", 0.f, 0.f, 2.f, 1.f, 1.f, Unit::Detector, ID::EnvFolDetector, 0.f },
+		{ ID::EnvFolWindow, "EnvFolWindow", "envfolwindow", 10.f, 1.f, 50.f, 0.f, 1.f, Unit::Ms, ID::EnvFolWindow, 0.f },
+		{ ID::EnvFolLookahead, "EnvFolLookahead", "envfollookahead", 0.f, 0.f, 10.f, 0.f, 1.f, Unit::Ms, ID::EnvFolLookahead, 0.f },
+
+		{ ID::MBEnvFolGain, "MBEnvFolGain", "mbenvfolgain", 1.f, 0.f, 24.f, 0.f, 1.f, Unit::Db, ID::MBEnvFolGain, 0.f },
+		{ ID::MBEnvFolAtk, "MBEnvFolAtk", "mbenvfolatk", 20.f, 6.f, 1000.f, 0.f, 1.f, Unit::Ms, ID::MBEnvFolAtk, 0.f },
+		{ ID::MBEnvFolRls, "MBEnvFolRls", "mbenvfolrls", 200.f, 6.f, 1000.f, 0.f, 1.f, Unit::Ms, ID::MBEnvFolRls, 0.f },
+		{ ID::MBEnvFolXLow, "MBEnvFolXLow", "mbenvfolxlow", 150.f, 20.f, 20000.f, 0.f, .25f, Unit::Hz, ID::MBEnvFolXLow, 1.f / 64.f },
+		{ ID::MBEnvFolXMid, "MBEnvFolXMid", "mbenvfolxmid", 1000.f, 20.f, 20000.f, 0.f, .25f, Unit::Hz, ID::MBEnvFolXMid, 1.f / 64.f },
+		{ ID::MBEnvFolXHigh, "MBEnvFolXHigh", "mbenvfolxhigh", 5000.f, 20.f, 20000.f, 0.f, .25f, Unit::Hz, ID::MBEnvFolXHigh, 1.f / 64.f },
+
+		{ ID::EnvFolDecimation, "EnvFolDecimation", "envfoldecimation", 0.f, 0.f, .25f, 0.f, 1.f, Unit::Percent, ID::EnvFolDecimation, 0.f }
+	};
+	static constexpr int NumParams = static_cast<int>(sizeof(descriptors) / sizeof(descriptors[0]));
+
+	/* lowerID has to be name in lower case without spaces, as the host and old sessions know it */
+	constexpr bool isIDOfName(const char* id, const char* name) {
+		for (; *name != 0; ++name) {
+			if (*name == ' ') continue;
+			const auto c = *name >= 'A' && *name <= 'Z' ? static_cast<char>(*name - 'A' + 'a') : *name;
+			if (c != *id) return false;
+			++id;
+		}
+		return *id == 0;
+	}
+	constexpr bool isValidTable() {
+		for (auto i = 0; i < NumParams; ++i)
+			if (static_cast<int>(descriptors[i].id) != i || !isIDOfName(descriptors[i].lowerID, descriptors[i].name))
+				return false;
+		return true;
+	}
+	static_assert(isValidTable(), "param::descriptors must be in ID order with matching ids");
+
+	static constexpr const Descriptor& getDescriptor(const ID i) { return descriptors[static_cast<int>(i)]; }
+	/* the matrix creates its parameters in table order, so a parameter's handle is its ID */
+	static constexpr int getHandle(const ID i) { return static_cast<int>(i); }
+	static juce::String getName(const ID i) { return getDescriptor(i).name; }
+	static juce::String getName(const int i) { return getName(static_cast<ID>(i)); }
+	static juce::String getID(const ID i) { return getDescriptor(i).lowerID; }
+	static juce::String getID(const int i) { return getID(static_cast<ID>(i)); }
+
+	/*
+	* generic parameters for modulators that get added at runtime. they come after
+	* the table, so slot s' parameter p has the handle NumParams + s * ParamsPerSlot + p
+	*/
+	static constexpr int NumSlots = 16;
+	static constexpr int ParamsPerSlot = 8;
+	static juce::String getSlotID(const int slot, const int p) {
+		return "slot" + juce::String(slot) + "p" + juce::String(p);
+	}
+	static juce::String getSlotName(const int slot, const int p) {
+		return "Slot " + juce::String(slot) + " P" + juce::String(p);
+	}
+
+	static juce::StringArray getIDs() {
+		juce::StringArray ids;
+		for (const auto& d : descriptors)
+			ids.add(d.lowerID);
+		for (auto s = 0; s < NumSlots; ++s)
+			for (auto p = 0; p < ParamsPerSlot; ++p)
+				ids.add(getSlotID(s, p));
+		return ids;
+	}
+	/* the ranges of numParams consecutive parameters, so a slot modulator can read its parameters like these */
+	static std::vector<juce::NormalisableRange<float>> getRanges(const ID first, const int numParams) {
+		std::vector<juce::NormalisableRange<float>> ranges;
+		for (auto i = static_cast<int>(first); i < static_cast<int>(first) + numParams; ++i) {
+			const auto& d = descriptors[i];
+			ranges.emplace_back(d.min, d.max, d.interval, d.skew);
+		}
+		return ranges;
+	}
+	/* the same for parameters that were appended to the table later */
+	static std::vector<juce::NormalisableRange<float>> getRanges(std::initializer_list<ID> ids) {
+		std::vector<juce::NormalisableRange<float>> ranges;
+		for (const auto i : ids) {
+			const auto& d = getDescriptor(i);
+			ranges.emplace_back(d.min, d.max, d.interval, d.skew);
 		}
+		return ranges;
 	}
-	static juce::String getName(int i) { getName(static_cast<ID>(i)); }
-	static juce::String getID(const ID i) { return getName(i).toLowerCase().removeCharacters(" "); }
-	static juce::String getID(const int i) { return getName(i).toLowerCase().removeCharacters(" "); }
 
 	struct MultiRange {
 		struct Range
@@ -73,6 +174,14 @@ namespace param {
 					return r.getID();
 			return ranges[0].getID();
 		}
+		/* resolve once, then index with operator()(int) */
+		int getHandle(const juce::String& idStr) const {
+			for (auto r = 0; r < ranges.size(); ++r)
+				if (ranges[r].getID().toString() == idStr)
+					return r;
+			return 0;
+		}
+		const juce::NormalisableRange<float>& operator()(const int handle) const noexcept { return ranges[handle](); }
 	private:
 		std::vector<Range> ranges;
 	};
@@ -186,6 +295,35 @@ namespace param {
 		return [](float value, int) {
 			return static_cast<juce::String>(std::rint(value)).substring(0, 5) + " db"; };
 	}
+	static std::function<juce::String(float, int)> getHzStr() {
+		return [](float value, int) {
+			return static_cast<juce::String>(std::rint(value)).substring(0, 5) + " hz"; };
+	}
+
+	static std::function<juce::String(float, int)> getValueStr(const Unit unit) {
+		switch (unit) {
+		case Unit::Ms: return getMsStr();
+		case Unit::Db: return getDbStr();
+		case Unit::Hz: return getHzStr();
+		case Unit::Octaves: return [](float value, int) {
+			return juce::String(static_cast<int>(value)) + " oct"; };
+		case Unit::Detector: return [](float value, int) {
+			return value < 1 ?
+				juce::String("ENV") : value < 2 ?
+				juce::String("PEAK") :
+				juce::String("RMS"); };
+		case Unit::WaveTable: return [](float value, int) {
+			return value < 1 ?
+				juce::String("SAW") : value < 2 ?
+				juce::String("SIN") :
+				juce::String("SQR"); };
+		case Unit::Noise: return [](float value, int) {
+			return value < 1 ?
+				juce::String("VALUE") :
+				juce::String("GRAD"); };
+		default: return [](float value, int) { return static_cast<juce::String>(std::rint(value * 100.f)); };
+		}
+	}
 
 	static std::function<juce::String(bool, int)> getSyncStr() {
 		return [](bool value, int) {
@@ -215,55 +353,27 @@ namespace param {
 	static juce::AudioProcessorValueTreeState::ParameterLayout createParameters(const juce::AudioProcessorValueTreeState& apvts, MultiRange& lfoFreeSyncRanges) {
 		std::vector<std::unique_ptr<juce::RangedAudioParameter>> parameters;
 
-		parameters.push_back(createParameter(ID::Macro0, 0.f));
-		parameters.push_back(createParameter(ID::Macro1, 0.f));
-		parameters.push_back(createParameter(ID::Macro2, 0.f));
-		parameters.push_back(createParameter(ID::Macro3, 0.f));
-		parameters.push_back(createParameter(ID::Depth, 1.f));
-		parameters.push_back(createParameter(ID::ModulesMix, 0.5f));
-
-		parameters.push_back(createParameter(ID::EnvFolGain, 1.f, juce::NormalisableRange<float>(0.f, 24.f), getDbStr()));
-		parameters.push_back(createParameter(ID::EnvFolAtk, 1.f, juce::NormalisableRange<float>(6.f, 1000.f), getMsStr()));
-		parameters.push_back(createParameter(ID::EnvFolRls, 0.5f, juce::NormalisableRange<float>(6.f, 1000.f), getMsStr()));
-		parameters.push_back(createParameter(ID::EnvFolBias, .5f));
-		parameters.push_back(createParameter(ID::EnvFolWdth, 1.f));
-
 		auto tsValues = getTempoSyncValues(6);
 		auto tsStrings = getTempoSyncStrings(6);
 
 		lfoFreeSyncRanges.add("free", { .1f, 20.f, 1.f });
 		lfoFreeSyncRanges.add("sync", getTempoSyncRange(tsValues));
 
-		auto rateStr = getRateStr(apvts, ID::LFOSync, lfoFreeSyncRanges("free"), tsStrings);
-
-		parameters.push_back(createPBool(ID::LFOSync, false, getSyncStr()));
-		parameters.push_back(createParameter(ID::LFORate, .5f, juce::NormalisableRange<float>(0.f, 1.f, 0.f), rateStr));
-		parameters.push_back(createParameter(ID::LFOWdth, 0.f, juce::NormalisableRange<float>(-1.f, 1.f, 0.f)));
-
-		const auto waveTableStrings = [](float value, int) {
-			return value < 1 ?
-				juce::String("SAW") : value < 2 ?
-				juce::String("SIN") :
-				juce::String("SQR");
-		};
-		rateStr = getRateStr(apvts, ID::RandSync, lfoFreeSyncRanges("free"), tsStrings);
-
-		parameters.push_back(createParameter(ID::LFOWaveTable, 0.f, juce::NormalisableRange<float>(0, 2, 1), waveTableStrings));
-
-		parameters.push_back(createPBool(ID::RandSync, false, getSyncStr()));
-		parameters.push_back(createParameter(ID::RandRate, .5f, juce::NormalisableRange<float>(0.f, 1.f, 0.f), rateStr));
-		parameters.push_back(createParameter(ID::RandBias, .5f));
-		parameters.push_back(createParameter(ID::RandWdth, 0.f));
-		parameters.push_back(createParameter(ID::RandSmooth, 1.f));
-
-		const auto octStr = [](float value, int) {
-			return juce::String(static_cast<int>(value)) + " oct";
-		};
-
-		parameters.push_back(createPBool(ID::PerlinSync, false, getSyncStr()));
-		parameters.push_back(createParameter(ID::PerlinRate, .5f, juce::NormalisableRange<float>(0.f, 1.f, 0.f), rateStr));
-		parameters.push_back(createParameter(ID::PerlinOctaves, 1.f, juce::NormalisableRange<float>(1.f, 8.f, 1.f), octStr));
-		parameters.push_back(createParameter(ID::PerlinWdth, 0.f));
+		for (const auto& d : descriptors) {
+			const juce::NormalisableRange<float> range(d.min, d.max, d.interval, d.skew);
+			if (d.unit == Unit::Sync)
+				parameters.push_back(createPBool(d.id, d.defaultValue != 0.f, getSyncStr()));
+			else if (d.unit == Unit::Rate)
+				parameters.push_back(createParameter(d.id, d.defaultValue, range, getRateStr(apvts, d.link, lfoFreeSyncRanges("free"), tsStrings)));
+			else
+				parameters.push_back(createParameter(d.id, d.defaultValue, range, getValueStr(d.unit)));
+		}
+		for (auto s = 0; s < NumSlots; ++s)
+			for (auto p = 0; p < ParamsPerSlot; ++p)
+				parameters.push_back(std::make_unique<juce::AudioParameterFloat>(
+					getSlotID(s, p), getSlotName(s, p), juce::NormalisableRange<float>(0.f, 1.f), 0.f, getSlotName(s, p),
+					juce::AudioProcessorParameter::Category::genericParameter,
+					getValueStr(Unit::Percent)));
 
 		return { parameters.begin(), parameters.end() };
 	}
@@ -272,7 +382,8 @@ namespace param {
 #include "ModSystem.h"
 
 struct ModularTestAudioProcessor :
-	public juce::AudioProcessor
+	public juce::AudioProcessor,
+	public juce::AudioProcessorParameter::Listener
 {
     ModularTestAudioProcessor();
     ~ModularTestAudioProcessor() override;
@@ -296,10 +407,45 @@ struct ModularTestAudioProcessor :
     void changeProgramName (int index, const juce::String& newName) override;
 	void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
+    void setStateInformationFromXml(const void* data, int sizeInBytes);
+	void loadRoutingsAsync(juce::MemoryBlock&& routings, const int flags);
+	void finishStateLoad();
+	void parameterValueChanged(int parameterIndex, float newValue) override;
+	void parameterGestureChanged(int, bool) override {}
 
 	param::MultiRange lfoFreeSyncRanges;
 	juce::AudioProcessorValueTreeState apvts;
 	ThreadSafePtr<modSys2::Matrix> matrix;
+	modSys2::AudioDelay lookaheadDelay;
+
+	/*
+	* the last state handed to the host. each section is only encoded again
+	* if its generation changed since, otherwise the blob is just copied
+	*/
+	struct StateCache {
+		StateCache() :
+			lock(),
+			parameters(),
+			routings(),
+			pendingRoutings(),
+			blob(),
+			parametersGeneration(-1),
+			routingsGeneration(-1),
+			pendingLoad(0)
+		{}
+		juce::CriticalSection lock;
+		juce::MemoryBlock parameters, routings, pendingRoutings, blob;
+		int parametersGeneration, routingsGeneration;
+		int pendingLoad; // the load pendingRoutings belong to, 0 if none
+	};
+	juce::Atomic<int> parametersGeneration;
+	StateCache stateCache;
+
+	/* called on the message thread once a state's routings are in the matrix, or were rejected */
+	std::function<void()> onStateLoaded;
+	juce::Atomic<int> stateLoads;
+	std::shared_ptr<int> lifetime; // lets pending callbacks know the processor is gone
+	juce::ThreadPool stateLoader; // last member, so its jobs are done before the rest gets destroyed
 	
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ModularTestAudioProcessor)
 };
\ No newline at end of file
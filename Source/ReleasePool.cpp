@@ -1,3 +1,4 @@
 #include "ReleasePool.h"
 
-ReleasePool ReleasePool::theReleasePool{};
\ No newline at end of file
+ReleasePool ReleasePool::theReleasePool{};
+SharedObjectCache SharedObjectCache::theSharedObjectCache{};
\ No newline at end of file
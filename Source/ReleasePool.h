@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include <map>
 
 /*
 * pointers to arbitrary underlying objects
@@ -29,6 +30,53 @@ protected:
     */
 };
 
+/*
+* process-wide cache of immutable objects that are shared by all plugin instances.
+* objects are keyed by a description of their content, built lazily on first
+* request and freed once the last instance that uses them is gone
+*/
+struct SharedObjectCache {
+    SharedObjectCache() :
+        objects(),
+        mutex()
+    {}
+    template<typename T>
+    std::shared_ptr<const T> get(const juce::String& key, const std::function<T()>& make) {
+        const juce::ScopedLock lock(mutex);
+        for (auto o = objects.begin(); o != objects.end();)
+            if (o->second.expired() && o->first != key) o = objects.erase(o);
+            else ++o;
+        auto& object = objects[key];
+        if (const auto ptr = object.lock())
+            return std::static_pointer_cast<const T>(ptr);
+        const auto newPtr = std::make_shared<const T>(make());
+        object = newPtr;
+        return newPtr;
+    }
+    /* fnv-1a of some bytes, for keys of objects that are defined by their content */
+    static juce::String hashOf(const void* data, const size_t numBytes) {
+        juce::uint64 hash = 14695981039346656037ull;
+        const auto bytes = static_cast<const juce::uint8*>(data);
+        for (size_t i = 0; i < numBytes; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return juce::String::toHexString(static_cast<juce::int64>(hash));
+    }
+    void dbg() const {
+        juce::String str("SOC Size: ");
+        str += juce::String(objects.size()) + " :: ";
+        for (const auto& o : objects)
+            str += o.first + " (" + juce::String(o.second.use_count()) + "), ";
+        DBG(str);
+    }
+
+    static SharedObjectCache theSharedObjectCache;
+private:
+    std::map<juce::String, std::weak_ptr<const void>> objects;
+    juce::CriticalSection mutex;
+};
+
 /*
 * releasePool for any object
 */
@@ -106,7 +154,10 @@ struct ThreadSafePtr {
         spinLock.exit();
     }
     std::shared_ptr<Type> getUpdatedPtr() noexcept {
-        return updatedPtr;
+        spinLock.enter();
+        auto ptr = updatedPtr;
+        spinLock.exit();
+        return ptr;
     }
     std::shared_ptr<Type> updateAndLoadCurrentPtr() noexcept {
         if (curPtr != updatedPtr)